@@ -6,7 +6,7 @@ renders it as a downloadable image, and visualizes the solution.
 """
 
 import streamlit as st
-import subprocess, json, tempfile, os, io
+import subprocess, json, tempfile, os, io, shutil, threading, queue, time
 from PIL import Image, ImageDraw, ImageFont
 
 # ==============================
@@ -31,6 +31,12 @@ with input_col:
         "C++ solver time limit per run (ms)",
         200, 10000, 2000, step=100
     )
+    keep_layout = st.checkbox(
+        "Keep the previous layout when editing words",
+        value=True,
+        help="Words already placed stay where they are; only new or displaced words are searched. "
+             "Generating again without editing the words always gives a fresh puzzle."
+    )
 
 with settings_col:
     st.markdown("### Visual Settings")
@@ -58,8 +64,11 @@ def convert_hex_to_rgb(hex_color, fallback=(0, 0, 0)):
         return fallback
 
 
-def run_cpp_solver(word_list, max_rows, max_cols, timeout_ms):
-    """Execute the C++ backend solver and return parsed JSON output."""
+def run_cpp_solver(word_list, max_rows, max_cols, timeout_ms, previous=None, extra_args=()):
+    """Execute the C++ backend solver and return parsed JSON output.
+
+    previous is an earlier result to warm-start from (same grid size);
+    extra_args are passed through (e.g. the --render options)."""
     executable = "./wordsearch_solver" if os.name != 'nt' else "wordsearch_solver.exe"
     if not os.path.exists(executable):
         st.error(f"C++ executable not found: {executable}. Compile it before running.")
@@ -68,29 +77,98 @@ def run_cpp_solver(word_list, max_rows, max_cols, timeout_ms):
     args = [executable, f"--timems={int(timeout_ms)}"]
     if max_rows > 0 and max_cols > 0:
         args += [f"--rows={max_rows}", f"--cols={max_cols}"]
+    previous_path = None
+    if previous:
+        with tempfile.NamedTemporaryFile("w", delete=False, suffix=".json") as previous_file:
+            json.dump(previous, previous_file)
+            previous_path = previous_file.name
+        args.append(f"--warm-start={previous_path}")
 
+    args += list(extra_args)
+    args.append("--progress=250")
     input_data = "\n".join(word_list) + "\n"
 
+    # Progress records arrive while the solver runs; show each early grid
+    # until the final result (the last line) replaces it. Lines are read on a
+    # helper thread so the wait has a deadline, after which the solver is killed
+    preview = st.empty()
+    output = ""
+    process = None
+    deadline = time.monotonic() + timeout_ms / 1000.0 + 5
     try:
-        result = subprocess.run(
+        process = subprocess.Popen(
             args,
-            input=input_data,
-            text=True,
-            capture_output=True,
-            timeout=(timeout_ms / 1000.0) + 5
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            text=True
         )
-        if result.returncode != 0:
-            st.error("C++ solver error:\n" + result.stderr)
+        lines = queue.Queue()
+        stderr_chunks = []
+
+        def pump_stdout():
+            for line in process.stdout:
+                lines.put(line)
+            lines.put(None)
+
+        threading.Thread(target=pump_stdout, daemon=True).start()
+        stderr_reader = threading.Thread(target=lambda: stderr_chunks.append(process.stderr.read()), daemon=True)
+        stderr_reader.start()
+        process.stdin.write(input_data)
+        process.stdin.close()
+        while True:
+            line = lines.get(timeout=max(0.0, deadline - time.monotonic()))
+            if line is None:
+                break
+            if not line.strip():
+                continue
+            output = line
+            try:
+                record = json.loads(line)
+            except json.JSONDecodeError:
+                raise RuntimeError("the solver printed a line that is not JSON; rebuild "
+                                   f"{executable} from this source tree (it must support --progress)")
+            if record.get("progress"):
+                preview.code(
+                    f"{len(record['placed_words'])} words placed after {record['elapsed_ms']} ms\n\n" +
+                    "\n".join(" ".join(row) for row in record["grid"])
+                )
+        process.wait(timeout=max(0.0, deadline - time.monotonic()))
+        preview.empty()
+        if process.returncode != 0:
+            stderr_reader.join(timeout=1)
+            st.error("C++ solver error:\n" + "".join(stderr_chunks))
+            return None
+        if not output:
+            st.error("C++ solver produced no result.")
             return None
-        return json.loads(result.stdout)
-    except subprocess.TimeoutExpired:
+        return json.loads(output)
+    except (queue.Empty, subprocess.TimeoutExpired):
         st.error("C++ process timed out.")
     except Exception as e:
         st.error(f"Error parsing C++ output: {e}")
-        st.write("Raw output:", result.stdout)
+        st.write("Raw output:", output)
+    finally:
+        if process and process.poll() is None:
+            process.kill()
+            process.wait()
+        preview.empty()
+        if previous_path:
+            os.remove(previous_path)
     return None
 
 
+def native_render_args(out_base, page_size, font_file, font_pt_size, font_hex, bg_hex, transparent_bg):
+    """Solver options that render the puzzle and solution PNGs natively."""
+    args = ["--render=png", f"--render-out={out_base}", f"--page={page_size}",
+            f"--font={font_file}", f"--font-size={int(font_pt_size)}",
+            "--fg=#%02x%02x%02x" % convert_hex_to_rgb(font_hex),
+            "--bg=#%02x%02x%02x" % convert_hex_to_rgb(bg_hex, (255, 255, 255))]
+    if transparent_bg:
+        args.append("--transparent")
+    return args
+
+
 def generate_puzzle_image(grid, word_positions, page_size, font_rgb, bg_rgb,
                           transparent_bg, font_file, file_format,
                           font_pt_size=72, use_default_font=False):
@@ -148,8 +226,31 @@ if st.button("Generate Puzzle"):
     if not word_list:
         st.error("Please enter at least one word.")
     else:
-        puzzle_data = run_cpp_solver(word_list, 0, 0, cpp_timeout_ms)
+        # An unchanged list would just get the same layout back, so only an
+        # edit carries the previous puzzle over
+        words_changed = word_list != st.session_state.get("last_words")
+        previous = st.session_state.get("last_puzzle") if keep_layout and words_changed else None
+
+        # Save uploaded font temporarily
+        temp_font_path = None
+        if custom_font_upload:
+            with tempfile.NamedTemporaryFile(delete=False, suffix=".ttf") as temp_font:
+                temp_font.write(custom_font_upload.read())
+                temp_font_path = temp_font.name
+
+        # With a TrueType font the solver renders both images itself; PIL's
+        # built-in bitmap font still needs the Python renderer
+        native_font = temp_font_path or ("Aaargh.ttf" if use_default_font and os.path.exists("Aaargh.ttf") else None)
+        render_dir = tempfile.mkdtemp() if native_font else None
+        render_args = ()
+        if native_font:
+            render_args = native_render_args(os.path.join(render_dir, "wordsearch"), paper_size, native_font,
+                                             font_size_pt, font_color_hex, background_color_hex, is_transparent_bg)
+
+        puzzle_data = run_cpp_solver(word_list, 0, 0, cpp_timeout_ms, previous, render_args)
         if puzzle_data:
+            st.session_state["last_puzzle"] = puzzle_data
+            st.session_state["last_words"] = word_list
             grid = puzzle_data["grid"]
             placements = puzzle_data["placements"]
             placed_words = puzzle_data["placed_words"]
@@ -160,21 +261,18 @@ if st.button("Generate Puzzle"):
             if unplaced_words:
                 st.warning("⚠️ Unplaced: " + ", ".join(unplaced_words))
 
-            # Save uploaded font temporarily
-            temp_font_path = None
-            if custom_font_upload:
-                with tempfile.NamedTemporaryFile(delete=False, suffix=".ttf") as temp_font:
-                    temp_font.write(custom_font_upload.read())
-                    temp_font_path = temp_font.name
-
             # Generate puzzle image
-            font_rgb = convert_hex_to_rgb(font_color_hex)
-            bg_rgb = convert_hex_to_rgb(background_color_hex, (255, 255, 255))
-            puzzle_image = generate_puzzle_image(
-                grid, placements, paper_size, font_rgb, bg_rgb,
-                is_transparent_bg, temp_font_path, output_format,
-                font_size_pt, use_default_font
-            )
+            if native_font:
+                puzzle_image = Image.open(os.path.join(render_dir, "wordsearch.png"))
+                puzzle_image.load()
+            else:
+                font_rgb = convert_hex_to_rgb(font_color_hex)
+                bg_rgb = convert_hex_to_rgb(background_color_hex, (255, 255, 255))
+                puzzle_image = generate_puzzle_image(
+                    grid, placements, paper_size, font_rgb, bg_rgb,
+                    is_transparent_bg, temp_font_path, output_format,
+                    font_size_pt, use_default_font
+                )
             st.image(puzzle_image, width=min(puzzle_image.width, 1200))
 
             # Download puzzle
@@ -185,22 +283,26 @@ if st.button("Generate Puzzle"):
                                file_name=f"wordsearch.{output_format.lower()}")
 
             # Generate and show solution
-            solution_image = puzzle_image.copy()
-            draw = ImageDraw.Draw(solution_image)
-            page_dimensions = {"A5": (1748, 2480), "A4": (2480, 3508), "A3": (3508, 4961)}
-            width, height = page_dimensions.get(paper_size, page_dimensions["A4"])
-            margin = int(min(width, height) * 0.06)
-            usable_w, usable_h = width - 2 * margin, height - 2 * margin
-            rows, cols = len(grid), len(grid[0])
-            cell_size = min(usable_w // cols, usable_h // rows)
-            start_x, start_y = (width - cell_size * cols) // 2, (height - cell_size * rows) // 2
-
-            for word_data in placements:
-                for k in range(len(word_data["word"])):
-                    x = start_x + (word_data["col"] + k * word_data["dc"]) * cell_size
-                    y = start_y + (word_data["row"] + k * word_data["dr"]) * cell_size
-                    draw.rectangle([x + 2, y + 2, x + cell_size - 3, y + cell_size - 3],
-                                   outline=(255, 0, 0), width=3)
+            if native_font:
+                solution_image = Image.open(os.path.join(render_dir, "wordsearch_solution.png"))
+                solution_image.load()
+            else:
+                solution_image = puzzle_image.copy()
+                draw = ImageDraw.Draw(solution_image)
+                page_dimensions = {"A5": (1748, 2480), "A4": (2480, 3508), "A3": (3508, 4961)}
+                width, height = page_dimensions.get(paper_size, page_dimensions["A4"])
+                margin = int(min(width, height) * 0.06)
+                usable_w, usable_h = width - 2 * margin, height - 2 * margin
+                rows, cols = len(grid), len(grid[0])
+                cell_size = min(usable_w // cols, usable_h // rows)
+                start_x, start_y = (width - cell_size * cols) // 2, (height - cell_size * rows) // 2
+
+                for word_data in placements:
+                    for k in range(len(word_data["word"])):
+                        x = start_x + (word_data["col"] + k * word_data["dc"]) * cell_size
+                        y = start_y + (word_data["row"] + k * word_data["dr"]) * cell_size
+                        draw.rectangle([x + 2, y + 2, x + cell_size - 3, y + cell_size - 3],
+                                       outline=(255, 0, 0), width=3)
 
             solution_buffer = io.BytesIO()
             solution_image.save(solution_buffer, format=output_format)
@@ -210,9 +312,11 @@ if st.button("Generate Puzzle"):
             st.download_button("⬇️ Download Solution", solution_buffer,
                                file_name=f"wordsearch_solution.{output_format.lower()}")
 
-            # Cleanup
-            if temp_font_path:
-                try:
-                    os.remove(temp_font_path)
-                except Exception:
-                    pass
+        # Cleanup
+        if temp_font_path:
+            try:
+                os.remove(temp_font_path)
+            except Exception:
+                pass
+        if render_dir:
+            shutil.rmtree(render_dir, ignore_errors=True)
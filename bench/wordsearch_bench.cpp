@@ -0,0 +1,177 @@
+/*
+=====================================================================
+WORD SEARCH SOLVER BENCHMARK
+---------------------------------------------------------------------
+Runs every engine over the fixed corpus in bench/corpus at several grid
+sizes, each solve capped by a node budget and seeded, so two builds can
+be compared like for like: the placements only change when the search
+does, and the timings only when its speed does.
+
+  g++ -O2 -std=c++17 -pthread bench/wordsearch_bench.cpp libwordsearch.cpp -o wordsearch_bench
+  ./wordsearch_bench [--corpus=bench/corpus] [--budget=N] [--engines=inplace,copy,bitboard,lns]
+                     [--filter=TEXT] [--repeat=N] [--threads=N] [--seed=S]
+                     [--order=length|isolated|dynamic|mixed]
+
+Per case it reports the best wall time of --repeat runs, the node rate,
+the time to the first layout with the final word counts, the time to the
+final best, and the quality reached (words placed, overlap). --budget
+replaces every case's own node budget; --order picks the word ordering
+of every solve.
+=====================================================================
+*/
+
+#include "../libwordsearch.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+using namespace std;
+using namespace wordsearch;
+
+/*---------------------------------------------------------------
+  CORPUS
+---------------------------------------------------------------*/
+
+// One word list at one board size, and the node budget of each solve
+// (nodes cost far more on big boards with long lists)
+struct BenchCase {
+    const char *file;
+    int rows, cols;
+    long long node_budget;
+};
+
+// Small, themed, long-word and 500-word lists, each at a tight and a roomy size
+const BenchCase BENCH_CASES[] = {
+    {"small.txt", 8, 8, 200000},        {"small.txt", 10, 10, 200000},
+    {"animals.txt", 12, 12, 50000},     {"animals.txt", 15, 15, 200000},
+    {"long_words.txt", 15, 15, 50000},  {"long_words.txt", 20, 20, 200000},
+    {"words500.txt", 40, 40, 5000},     {"words500.txt", 50, 50, 5000},
+};
+
+struct BenchEngine {
+    const char *name;
+    SolverEngine engine;
+};
+
+const BenchEngine BENCH_ENGINES[] = {
+    {"inplace", ENGINE_INPLACE}, {"copy", ENGINE_COPY}, {"bitboard", ENGINE_BITBOARD}, {"lns", ENGINE_LNS},
+};
+
+// One word per line, * marking must-include words; false if unreadable
+bool loadWordList(const string &path, vector<string> &words, vector<bool> &required_flags) {
+    ifstream file(path);
+    if(!file) return false;
+    string line;
+    while(getline(file, line)) {
+        bool required = line.find('*') != string::npos;
+        string word = normalizeWord(line);
+        if(word.empty()) continue;
+        words.push_back(word);
+        required_flags.push_back(required);
+    }
+    return true;
+}
+
+/*---------------------------------------------------------------
+  MEASUREMENT
+---------------------------------------------------------------*/
+
+struct BenchRun {
+    double wall_ms = 0;
+    PuzzleResult result;
+};
+
+BenchRun runOnce(const SolverConfig &config, const vector<string> &words, const vector<bool> &required_flags) {
+    BenchRun run;
+    Solver solver(config);
+    auto start = chrono::steady_clock::now();
+    run.result = solver.solve(words, required_flags);
+    run.wall_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+// Milliseconds until the best first reached the final word counts, and
+// until the final best itself; -1 without a log
+void improvementTimes(const SolverStats &stats, const PuzzleResult &result, double &first_ms, double &best_ms) {
+    first_ms = best_ms = -1;
+    for(auto &step : stats.improvements)
+        if(first_ms < 0 && step.required == result.num_required_placed && step.placed == result.num_placed)
+            first_ms = step.elapsed_us / 1000.0;
+    if(!stats.improvements.empty()) best_ms = stats.improvements.back().elapsed_us / 1000.0;
+}
+
+/*---------------------------------------------------------------
+  MAIN FUNCTION
+---------------------------------------------------------------*/
+int main(int argc, char** argv) {
+    string corpus = "bench/corpus", engines = "inplace,copy,bitboard,lns", filter;
+    long long budget = 0;   // 0: each case's own
+    int repeat = 3, threads = 1;
+    uint64_t seed = 1;
+    WordOrdering ordering = ORDER_LENGTH;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg.rfind("--corpus=", 0) == 0) corpus = arg.substr(9);
+        else if(arg.rfind("--budget=", 0) == 0) budget = stoll(arg.substr(9));
+        else if(arg.rfind("--engines=", 0) == 0) engines = arg.substr(10);
+        else if(arg.rfind("--filter=", 0) == 0) filter = arg.substr(9);
+        else if(arg.rfind("--repeat=", 0) == 0) repeat = max(1, stoi(arg.substr(9)));
+        else if(arg.rfind("--threads=", 0) == 0) threads = max(1, stoi(arg.substr(10)));
+        else if(arg.rfind("--seed=", 0) == 0) seed = stoull(arg.substr(7));
+        else if(arg == "--order=length") ordering = ORDER_LENGTH;
+        else if(arg == "--order=isolated") ordering = ORDER_ISOLATED;
+        else if(arg == "--order=dynamic") ordering = ORDER_DYNAMIC;
+        else if(arg == "--order=mixed") ordering = ORDER_MIXED;
+        else {
+            cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if(!WORDSEARCH_STATS) cerr << "Built with WORDSEARCH_STATS=0: node counts and times to best are unavailable.\n";
+
+    printf("%-16s %-6s %-9s %10s %11s %9s %9s %9s %8s %8s\n", "corpus", "size", "engine", "wall_ms", "nodes",
+           "knodes/s", "first_ms", "best_ms", "placed", "overlap");
+    for(auto &bench : BENCH_CASES) {
+        string label = string(bench.file) + " " + to_string(bench.rows) + "x" + to_string(bench.cols);
+        if(!filter.empty() && label.find(filter) == string::npos) continue;
+        vector<string> words;
+        vector<bool> required_flags;
+        if(!loadWordList(corpus + "/" + bench.file, words, required_flags)) {
+            cerr << "Cannot read " << corpus << "/" << bench.file << "\n";
+            return 1;
+        }
+
+        for(auto &engine : BENCH_ENGINES) {
+            if(("," + engines + ",").find(string(",") + engine.name + ",") == string::npos) continue;
+            SolverConfig config;
+            config.rows = bench.rows;
+            config.cols = bench.cols;
+            config.engine = engine.engine;
+            config.threads = threads;
+            config.node_budget = budget ? budget : bench.node_budget;
+            config.seed = seed;
+            config.ordering = ordering;
+
+            // Budgeted runs repeat exactly, so only the fastest one matters
+            BenchRun best = runOnce(config, words, required_flags);
+            for(int r = 1; r < repeat; r++) {
+                BenchRun run = runOnce(config, words, required_flags);
+                if(run.wall_ms < best.wall_ms) best = move(run);
+            }
+
+            const PuzzleResult &result = best.result;
+            double first_ms, best_ms;
+            improvementTimes(result.stats, result, first_ms, best_ms);
+            string size = to_string(bench.rows) + "x" + to_string(bench.cols);
+            string placed = to_string(result.num_placed) + "/" + to_string(words.size());
+            printf("%-16s %-6s %-9s %10.1f %11lld %9.0f %9.1f %9.1f %8s %8d\n", bench.file, size.c_str(),
+                   engine.name, best.wall_ms, result.stats.nodes, result.stats.nodes / max(best.wall_ms, 1e-3),
+                   first_ms, best_ms, placed.c_str(), result.total_overlap_score);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+=====================================================================
+BINARY RESULT FORMAT (--format=bin)
+---------------------------------------------------------------------
+One self-delimiting little-endian record per puzzle, readable with
+numpy.frombuffer / mmap and no parsing (see wordsearch_bin.py):
+
+  offset  size  field
+       0     4  magic "WSRB"
+       4     2  version (1)
+       6     2  flags (bit 0: error record)
+       8     2  rows
+      10     2  cols
+      12     4  placement count P
+      16     4  word count W
+      20     4  total overlap score
+      24     4  record size in bytes, header included
+      28     4  reserved (0)
+      32        grid: rows * cols letter bytes, row-major,
+                zero-padded to a multiple of 8
+                placements: P x {u16 word_id, u16 row, u16 col,
+                u8 dir_index, u8 reserved}; word_id indexes the word
+                table, dir_index indexes DIRECTIONS
+                word table: W x {u16 length, letters}
+                id: {u16 length, text} of the request id (length 0 when
+                none), then zero padding to a multiple of 8
+
+An error record has rows = cols = P = 0 and the message as its only
+word-table entry.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_BINARY_FORMAT_H
+#define WORDSEARCH_BINARY_FORMAT_H
+
+#include "libwordsearch.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint16_t BIN_VERSION = 1;
+const uint16_t BIN_FLAG_ERROR = 1;
+const size_t BIN_HEADER_SIZE = 32;
+
+inline void binPut16(std::string &out, uint16_t v) {
+    out.push_back((char)(v & 0xFF));
+    out.push_back((char)(v >> 8));
+}
+
+inline void binPut32(std::string &out, uint32_t v) {
+    for(int shift = 0; shift < 32; shift += 8) out.push_back((char)((v >> shift) & 0xFF));
+}
+
+inline void binPad8(std::string &out, size_t record_start) {
+    while((out.size() - record_start) % 8) out.push_back('\0');
+}
+
+// Patch the record size field once the record is complete
+inline void binFinish(std::string &out, size_t record_start) {
+    binPad8(out, record_start);
+    uint32_t size = (uint32_t)(out.size() - record_start);
+    for(int i = 0; i < 4; i++) out[record_start + 24 + i] = (char)((size >> (8 * i)) & 0xFF);
+}
+
+inline void binHeader(std::string &out, uint16_t flags, int rows, int cols, size_t placements, size_t words,
+                      int overlap) {
+    out.append("WSRB", 4);
+    binPut16(out, BIN_VERSION);
+    binPut16(out, flags);
+    binPut16(out, (uint16_t)rows);
+    binPut16(out, (uint16_t)cols);
+    binPut32(out, (uint32_t)placements);
+    binPut32(out, (uint32_t)words);
+    binPut32(out, (uint32_t)overlap);
+    binPut32(out, 0);   // record size, patched by binFinish
+    binPut32(out, 0);
+}
+
+inline void binString(std::string &out, const std::string &text) {
+    binPut16(out, (uint16_t)text.size());
+    out.append(text);
+}
+
+// Append one result record; words is the list the result was solved for,
+// which word_id values index
+inline void appendBinaryResult(std::string &out, const wordsearch::PuzzleResult &result,
+                               const std::vector<std::string> &words, const std::string &id = "") {
+    size_t start = out.size();
+    const wordsearch::Grid &grid = result.grid;
+    binHeader(out, 0, grid.rows, grid.cols, result.placements.size(), words.size(), result.total_overlap_score);
+
+    for(int r = 0; r < grid.rows; r++) out.append(grid.cells.data() + grid.index(r, 0), grid.cols);
+    binPad8(out, start);
+
+    for(auto &p : result.placements) {
+        int dir_index = 0;
+        for(int d = 0; d < (int)wordsearch::DIRECTIONS.size(); d++)
+            if(wordsearch::DIRECTIONS[d] == std::make_pair(p.delta_row, p.delta_col)) dir_index = d;
+        binPut16(out, (uint16_t)p.word_index);
+        binPut16(out, (uint16_t)p.row);
+        binPut16(out, (uint16_t)p.col);
+        out.push_back((char)dir_index);
+        out.push_back('\0');
+    }
+
+    for(auto &w : words) binString(out, w);
+    binString(out, id);
+    binFinish(out, start);
+}
+
+inline void appendBinaryError(std::string &out, const std::string &message, const std::string &id = "") {
+    size_t start = out.size();
+    binHeader(out, BIN_FLAG_ERROR, 0, 0, 0, 1, 0);
+    binString(out, message);
+    binString(out, id);
+    binFinish(out, start);
+}
+
+#endif
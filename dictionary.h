@@ -0,0 +1,120 @@
+/*
+=====================================================================
+WORD DICTIONARY
+---------------------------------------------------------------------
+Large word-list files (--dict) are memory-mapped and normalized in one
+pass into a single contiguous arena of letters; each entry is just an
+offset/length view into it. Sampling picks entries by index, so only
+the words actually handed to the solver become std::strings.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_DICTIONARY_H
+#define WORDSEARCH_DICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <random>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+#include <cctype>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+class WordDictionary {
+public:
+    struct Entry {
+        uint32_t offset;
+        uint16_t length;
+        bool required;        // the line started with *
+    };
+
+    std::string letters;      // every normalized word, back to back
+    std::vector<Entry> entries;
+
+    // Map and normalize a file with one word per line; false if unreadable
+    bool load(const std::string &path) {
+#ifndef _WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat info;
+        if(fstat(fd, &info) < 0) { close(fd); return false; }
+        size_t size = info.st_size;
+        if(size == 0) { close(fd); return true; }
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(mapped == MAP_FAILED) return false;
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        index((const char *)mapped, size);
+        munmap(mapped, size);
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if(!file) return false;
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        index(text.data(), text.size());
+        return true;
+#endif
+    }
+
+    size_t size() const { return entries.size(); }
+
+    std::string word(size_t i) const { return letters.substr(entries[i].offset, entries[i].length); }
+
+    // Append entry i to the solver inputs
+    void take(size_t i, std::vector<std::string> &words, std::vector<bool> &required_flags) const {
+        words.push_back(word(i));
+        required_flags.push_back(entries[i].required);
+    }
+
+    // k distinct entries chosen uniformly for a given seed (Floyd's
+    // algorithm, so only the chosen indices are ever stored)
+    std::vector<size_t> sample(size_t k, uint64_t seed) const {
+        std::vector<size_t> chosen;
+        size_t n = entries.size();
+        if(k >= n) {
+            for(size_t i = 0; i < n; i++) chosen.push_back(i);
+            return chosen;
+        }
+        std::mt19937_64 rng(seed);
+        std::unordered_set<size_t> seen;
+        seen.reserve(k * 2);
+        for(size_t j = n - k; j < n; j++) {
+            size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+            size_t pick = seen.count(t) ? j : t;
+            seen.insert(pick);
+            chosen.push_back(pick);
+        }
+        return chosen;
+    }
+
+private:
+    // Normalize every line of text into the arena (uppercase letters only,
+    // as normalizeWord); lines with no letters are dropped
+    void index(const char *text, size_t size) {
+        letters.reserve(size);
+        const char *end = text + size;
+        while(text < end) {
+            const char *line_end = text;
+            while(line_end < end && *line_end != '\n') line_end++;
+            while(text < line_end && (*text == ' ' || *text == '\t')) text++;
+            bool required = text < line_end && *text == '*';
+            size_t start = letters.size();
+            for(; text < line_end; text++)
+                if(isalpha((unsigned char)*text)) letters.push_back((char)toupper((unsigned char)*text));
+            size_t length = letters.size() - start;
+            if(length > 0 && length <= UINT16_MAX) entries.push_back({(uint32_t)start, (uint16_t)length, required});
+            else letters.resize(start);
+            text = line_end + 1;
+        }
+        letters.shrink_to_fit();
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*
+=====================================================================
+JSON WRITER
+---------------------------------------------------------------------
+Appends JSON text to one reusable buffer: integers go through
+std::to_chars and strings are escaped in place, so formatting a result
+costs no per-field allocations and the caller emits it with one write.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_JSON_WRITER_H
+#define WORDSEARCH_JSON_WRITER_H
+
+#include <string>
+#include <charconv>
+#include <cstdio>
+
+class JsonWriter {
+public:
+    std::string buffer;
+
+    void clear() { buffer.clear(); }
+    void reserve(size_t bytes) { buffer.reserve(bytes); }
+
+    void raw(char ch) { buffer.push_back(ch); }
+    void raw(const char *text) { buffer.append(text); }
+    void raw(const std::string &text) { buffer.append(text); }
+
+    void integer(long long value) {
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        buffer.append(digits, end - digits);
+    }
+
+    // Quoted, escaped string; runs of plain characters are copied in one go
+    void string(const std::string &text) {
+        buffer.push_back('"');
+        size_t start = 0;
+        for(size_t i = 0; i < text.size(); i++) {
+            unsigned char ch = text[i];
+            if(ch != '"' && ch != '\\' && ch >= 0x20) continue;
+            buffer.append(text, start, i - start);
+            if(ch == '"' || ch == '\\') {
+                buffer.push_back('\\');
+                buffer.push_back(ch);
+            } else {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", ch);
+                buffer.append(esc);
+            }
+            start = i + 1;
+        }
+        buffer.append(text, start, std::string::npos);
+        buffer.push_back('"');
+    }
+
+    // "name": with an optional space after the colon
+    void key(const char *name, bool spaced) {
+        buffer.push_back('"');
+        buffer.append(name);
+        buffer.append(spaced ? "\": " : "\":");
+    }
+
+    // Emit the buffer with a single write
+    void flushTo(FILE *out) const {
+        fwrite(buffer.data(), 1, buffer.size(), out);
+        fflush(out);
+    }
+};
+
+// Quote and escape a string for JSON output
+inline std::string jsonQuote(const std::string &text) {
+    JsonWriter writer;
+    writer.string(text);
+    return writer.buffer;
+}
+
+#endif
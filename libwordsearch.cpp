@@ -0,0 +1,1807 @@
+/*
+=====================================================================
+LIBWORDSEARCH - SOLVER IMPLEMENTATION
+---------------------------------------------------------------------
+Recursive backtracking search that maximizes overlap between words.
+All state is per Solver / per solve, so solves may run concurrently.
+=====================================================================
+*/
+
+#include "libwordsearch.h"
+
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <memory>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+using namespace std;
+
+namespace wordsearch {
+
+/*---------------------------------------------------------------
+  HELPER FUNCTIONS
+---------------------------------------------------------------*/
+
+// Convert string to uppercase alphabetic only
+string normalizeWord(const string &input) {
+    string clean;
+    for(char ch : input)
+        if(isalpha((unsigned char)ch))
+            clean.push_back(toupper((unsigned char)ch));
+    return clean;
+}
+
+namespace {
+
+/*---------------------------------------------------------------
+  GRID VALIDATION & PLACEMENT
+---------------------------------------------------------------*/
+
+// Validate word placement and count overlaps (pos/step are flat grid offsets)
+bool canPlaceWord(const Grid& grid, const string &word, int pos, int step, int &overlap_count) {
+    overlap_count = 0;
+    const char *cells = grid.cells.data();
+    for(char ch : word) {
+        char existing = cells[pos];
+        if(existing != '.' && existing != ch) return false;
+        if(existing == ch) overlap_count++;
+        pos += step;
+    }
+    return true;
+}
+
+// Write word into grid
+void placeWord(Grid& grid, const string &word, int pos, int step) {
+    for(char ch : word) {
+        grid.set(pos, ch);
+        pos += step;
+    }
+}
+
+// Write word into grid, logging the cells that were empty before
+void placeWordWithUndo(Grid& grid, const string &word, int pos, int step, pmr::vector<int>& undo_log) {
+    for(char ch : word) {
+        if(grid.cells[pos] == '.') {
+            grid.set(pos, ch);
+            undo_log.push_back(pos);
+        }
+        pos += step;
+    }
+}
+
+// Roll back every cell logged after the given mark
+void undoPlacement(Grid& grid, pmr::vector<int>& undo_log, size_t mark) {
+    while(undo_log.size() > mark) {
+        grid.set(undo_log.back(), '.');
+        undo_log.pop_back();
+    }
+}
+
+/*---------------------------------------------------------------
+  VECTORIZED PLACEMENT KERNELS
+---------------------------------------------------------------*/
+
+// One letter of a word: how often it occurs, and where as a bitmask from
+// the word's first letter (first GRID_BITBOARD_MAX letters only)
+struct LetterBits {
+    int letter;
+    int count;
+    uint64_t bits;
+};
+
+// Word letters forwards and backwards, zero-padded for full-register loads,
+// plus per-letter position masks for the bitboard check
+struct WordPattern {
+    int length = 0;
+    pmr::string forward, reversed;
+    uint64_t span = 0;
+    pmr::vector<LetterBits> forward_bits, reversed_bits;
+};
+
+void collectLetterBits(const string &text, pmr::vector<LetterBits> &out) {
+    for(int i = 0; i < (int)text.size(); i++) {
+        int letter = text[i] - 'A';
+        uint64_t bit = i < GRID_BITBOARD_MAX ? 1ULL << i : 0;
+        auto it = find_if(out.begin(), out.end(), [&](const LetterBits &b) { return b.letter == letter; });
+        if(it == out.end()) out.push_back({letter, 1, bit});
+        else { it->count++; it->bits |= bit; }
+    }
+}
+
+WordPattern makeWordPattern(const string &word, pmr::memory_resource *memory) {
+    WordPattern pattern{(int)word.size(), pmr::string(word, memory), pmr::string(word.rbegin(), word.rend(), memory),
+                        0, pmr::vector<LetterBits>(memory), pmr::vector<LetterBits>(memory)};
+    pattern.span = word.size() >= 64 ? ~0ULL : (1ULL << word.size()) - 1;
+    collectLetterBits(word, pattern.forward_bits);
+    collectLetterBits(string(word.rbegin(), word.rend()), pattern.reversed_bits);
+    pattern.forward.resize(word.size() + GRID_SIMD_SLACK, '\0');
+    pattern.reversed.resize(word.size() + GRID_SIMD_SLACK, '\0');
+    return pattern;
+}
+
+// Lane and reading order for each entry of DIRECTIONS
+static const struct { GridLane lane; bool forward; } DIRECTION_LANES[8] = {
+    {LANE_ROW, true}, {LANE_ROW, false}, {LANE_COL, true}, {LANE_COL, false},
+    {LANE_DIAG, true}, {LANE_ANTI, true}, {LANE_ANTI, false}, {LANE_DIAG, false}
+};
+
+// Check len contiguous cells against pattern: each must be '.' or equal
+typedef bool (*MatchRunKernel)(const char *cells, const char *pattern, int len, int &overlap_count);
+
+#if defined(__x86_64__) || defined(_M_X64)
+static bool matchRunSSE2(const char *cells, const char *pattern, int len, int &overlap_count) {
+    const __m128i empty = _mm_set1_epi8('.');
+    int count = 0;
+    for(int i = 0; i < len; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i *)(cells + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(pattern + i));
+        unsigned eq = _mm_movemask_epi8(_mm_cmpeq_epi8(g, w));
+        unsigned ok = eq | _mm_movemask_epi8(_mm_cmpeq_epi8(g, empty));
+        unsigned mask = len - i >= 16 ? 0xFFFFu : (1u << (len - i)) - 1;
+        if((ok & mask) != mask) return false;
+        count += __builtin_popcount(eq & mask);
+    }
+    overlap_count = count;
+    return true;
+}
+
+#if defined(__GNUC__)
+__attribute__((target("avx2,popcnt")))
+static bool matchRunAVX2(const char *cells, const char *pattern, int len, int &overlap_count) {
+    const __m256i empty = _mm256_set1_epi8('.');
+    int count = 0;
+    for(int i = 0; i < len; i += 32) {
+        __m256i g = _mm256_loadu_si256((const __m256i *)(cells + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(pattern + i));
+        uint32_t eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(g, w));
+        uint32_t ok = eq | (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(g, empty));
+        uint32_t mask = len - i >= 32 ? 0xFFFFFFFFu : (1u << (len - i)) - 1;
+        if((ok & mask) != mask) return false;
+        count += __builtin_popcount(eq & mask);
+    }
+    overlap_count = count;
+    return true;
+}
+#endif
+#endif
+
+#if defined(__aarch64__)
+// Loading 16 bytes at TAIL_MASK + 16 - n gives n leading 0xFF lanes
+static const uint8_t TAIL_MASK[32] = {
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+};
+
+static bool matchRunNEON(const char *cells, const char *pattern, int len, int &overlap_count) {
+    const uint8x16_t empty = vdupq_n_u8('.');
+    const uint8x16_t one = vdupq_n_u8(1);
+    int count = 0;
+    for(int i = 0; i < len; i += 16) {
+        uint8x16_t g = vld1q_u8((const uint8_t *)(cells + i));
+        uint8x16_t w = vld1q_u8((const uint8_t *)(pattern + i));
+        uint8x16_t mask = vld1q_u8(TAIL_MASK + 16 - min(16, len - i));
+        uint8x16_t eq = vceqq_u8(g, w);
+        uint8x16_t ok = vorrq_u8(eq, vceqq_u8(g, empty));
+        if(vminvq_u8(vornq_u8(ok, mask)) != 0xFF) return false;
+        count += vaddvq_u8(vandq_u8(vandq_u8(eq, mask), one));
+    }
+    overlap_count = count;
+    return true;
+}
+#endif
+
+// Pick the widest kernel this CPU supports, or nullptr for the scalar path
+MatchRunKernel selectMatchKernel() {
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__)
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return matchRunAVX2;
+#endif
+    return matchRunSSE2;
+#elif defined(__aarch64__)
+    return matchRunNEON;
+#else
+    return nullptr;
+#endif
+}
+
+// Vectorized canPlaceWord: match the run in the lane where the direction is
+// contiguous (grid must have shadow lanes); the end cell must be on the board
+bool canPlaceWordVector(MatchRunKernel kernel, const Grid& grid, const WordPattern &pattern,
+                        int r, int c, int er, int ec, int dir, int &overlap_count) {
+    const auto &lane = DIRECTION_LANES[dir];
+    if(lane.forward)
+        return kernel(grid.lanePointer(lane.lane, r, c), pattern.forward.data(), pattern.length, overlap_count);
+    return kernel(grid.lanePointer(lane.lane, er, ec), pattern.reversed.data(), pattern.length, overlap_count);
+}
+
+/*---------------------------------------------------------------
+  BITBOARD PLACEMENT CHECK
+---------------------------------------------------------------*/
+
+// canPlaceWord on the grid's bitboards: read the word's span of the lane for
+// its direction; every filled cell in it must hold the word's letter there,
+// so the placement fits when the per-letter matches cover the occupancy
+// (grid must have bitboards; the end cell must be on the board)
+bool canPlaceWordBitboard(const Grid &grid, const WordPattern &pattern, int r, int c, int er, int ec, int dir,
+                          int &overlap_count) {
+    const auto &lane = DIRECTION_LANES[dir];
+    int sr = lane.forward ? r : er, sc = lane.forward ? c : ec;
+    int l = grid.bitLane(lane.lane, sr, sc), shift = grid.bitOffset(lane.lane, sr, sc);
+    uint64_t occupied = grid.occupied_bits[lane.lane][l] & (pattern.span << shift);
+    overlap_count = 0;
+    if(!occupied) return true;
+
+    const uint64_t *letters = grid.letter_bits[lane.lane].data() + l;
+    int count = grid.laneCount(lane.lane);
+    uint64_t matched = 0;
+    for(const LetterBits &b : lane.forward ? pattern.forward_bits : pattern.reversed_bits)
+        matched |= letters[b.letter * count] & (b.bits << shift);
+    if(matched != occupied) return false;
+    overlap_count = __builtin_popcountll(matched);
+    return true;
+}
+
+/*---------------------------------------------------------------
+  GRID SHAPES
+---------------------------------------------------------------*/
+
+// DIRECTIONS as constant tables, so fixed-shape code folds its steps
+constexpr int DIRECTION_COUNT = 8;
+constexpr int DIR_ROW[DIRECTION_COUNT] = {0, 0, 1, -1, 1, 1, -1, -1};
+constexpr int DIR_COL[DIRECTION_COUNT] = {1, -1, 0, 0, 1, -1, 1, -1};
+
+// Grid::free_runs orientation of each direction, and whether it is the one
+// the runs are counted along (else the word is read from its far end)
+constexpr int FREE_RUN_LANE[DIRECTION_COUNT] = {0, 0, 1, 1, 2, 3, 3, 2};
+constexpr bool FREE_RUN_FORWARD[DIRECTION_COUNT] = {true, false, true, false, true, true, false, false};
+
+// Board geometry seen by the search: compile-time constants for the common
+// board sizes, so strides, steps and bounds fold into the generated code, or
+// the grid's runtime size when ROWS = COLS = 0
+template<int ROWS, int COLS>
+class GridShape {
+public:
+    explicit GridShape(const Grid &grid) : runtime_rows(grid.rows), runtime_cols(grid.cols) {}
+
+    int rows() const { if constexpr(ROWS > 0) return ROWS; else return runtime_rows; }
+    int cols() const { if constexpr(COLS > 0) return COLS; else return runtime_cols; }
+    int stride() const { return cols() + 2; }
+    int index(int r, int c) const { return (r + 1) * stride() + (c + 1); }
+    int step(int d) const { return DIR_ROW[d] * stride() + DIR_COL[d]; }
+    int rowOf(int pos) const { return pos / stride() - 1; }
+    int colOf(int pos) const { return pos % stride() - 1; }
+    bool contains(int r, int c) const { return (unsigned)r < (unsigned)rows() && (unsigned)c < (unsigned)cols(); }
+
+private:
+    int runtime_rows, runtime_cols;
+};
+
+/*---------------------------------------------------------------
+  SCRATCH MEMORY
+---------------------------------------------------------------*/
+
+// Upstream for the scratch arena: plain heap, counting what it hands out
+class CountingResource : public pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t align) override {
+        allocated += bytes;
+        return pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+        pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// Block kept by each thread between solves; it grows to the largest solve
+// seen (up to SCRATCH_MAX_RETAINED) so repeated solves on one thread, as in
+// batch and server mode, stop touching the heap for their scratch state
+struct ScratchBlock {
+    unique_ptr<max_align_t[]> data;
+    size_t size = 0;
+    bool in_use = false;
+};
+
+const size_t SCRATCH_MIN_BLOCK = 64 * 1024;
+const size_t SCRATCH_MAX_RETAINED = 64 * 1024 * 1024;
+
+// Monotonic arena for one worker's per-solve state, released in one go when
+// the worker finishes. A nested solve on the same thread gets its own arena
+class ScratchArena {
+public:
+    ScratchArena() {
+        static thread_local ScratchBlock block;
+        if(!block.in_use) {
+            owned = &block;
+            block.in_use = true;
+        }
+        if(owned && owned->size) arena.emplace(owned->data.get(), owned->size, &overflow);
+        else arena.emplace(SCRATCH_MIN_BLOCK, &overflow);
+    }
+
+    ~ScratchArena() {
+        arena.reset();
+        if(!owned) return;
+        size_t wanted = min(SCRATCH_MAX_RETAINED, max(SCRATCH_MIN_BLOCK, owned->size + overflow.allocated));
+        if(wanted > owned->size) {
+            size_t units = (wanted + sizeof(max_align_t) - 1) / sizeof(max_align_t);
+            owned->data.reset(new max_align_t[units]);
+            owned->size = units * sizeof(max_align_t);
+        }
+        owned->in_use = false;
+    }
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    pmr::memory_resource *resource() { return &*arena; }
+
+private:
+    CountingResource overflow;
+    optional<pmr::monotonic_buffer_resource> arena;
+    ScratchBlock *owned = nullptr;
+};
+
+/*---------------------------------------------------------------
+  SCORES
+---------------------------------------------------------------*/
+
+// (required words placed, words placed, total overlap) packed so one integer
+// compare ranks results: must-include words first, then coverage, then overlap
+inline int64_t packScore(int required, int placed, int overlap) {
+    return ((int64_t)required << 48) | ((int64_t)placed << 32) | (uint32_t)overlap;
+}
+inline int scoreRequired(int64_t score) { return (int)(score >> 48); }
+inline int scorePlaced(int64_t score) { return (int)((score >> 32) & 0xFFFF); }
+inline int scoreOverlap(int64_t score) { return (int)(uint32_t)score; }
+
+inline int64_t resultScore(const PuzzleResult &result) {
+    return packScore(result.num_required_placed, result.num_placed, result.total_overlap_score);
+}
+
+/*---------------------------------------------------------------
+  TRANSPOSITION TABLE
+---------------------------------------------------------------*/
+
+// splitmix64 finalizer, used to derive Zobrist keys on the fly
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Board symmetries: flips of either axis, plus the transposed variants on
+// square boards (the full dihedral group)
+inline int symmetryCount(int rows, int cols) { return rows == cols ? 8 : 4; }
+
+// Zobrist key of a letter at (r, c) once the board is mapped through symmetry s
+inline uint64_t cellKey(int s, int r, int c, int rows, int cols, char letter) {
+    if(s & 4) swap(r, c);
+    if(s & 1) c = cols - 1 - c;
+    if(s & 2) r = rows - 1 - r;
+    return mix64(((uint64_t)r << 40) ^ ((uint64_t)c << 8) ^ (uint64_t)(letter - 'A'));
+}
+
+// Bounded, lossy table of search states shared by all threads of a solve.
+// Each slot stores the hash xor-ed with its data, so a torn concurrent write
+// reads back as a miss instead of a wrong hit
+class TranspositionTable {
+public:
+    explicit TranspositionTable(int bits) : mask((1ULL << bits) - 1), slots(new Slot[1ULL << bits]) {}
+
+    // True when the state was already reached with at least this score in
+    // every component (its subtree can add nothing new); otherwise records
+    // this visit. score is a packScore value
+    bool dominated(uint64_t hash, int64_t score) {
+        Slot &slot = slots[hash & mask];
+        uint64_t data = slot.data.load(memory_order_relaxed);
+        uint64_t check = slot.check.load(memory_order_relaxed);
+        if((check ^ data) == hash && scoreRequired(data) >= scoreRequired(score) &&
+           scorePlaced(data) >= scorePlaced(score) && scoreOverlap(data) >= scoreOverlap(score))
+            return true;
+        data = score;
+        slot.data.store(data, memory_order_relaxed);
+        slot.check.store(hash ^ data, memory_order_relaxed);
+        return false;
+    }
+
+private:
+    struct Slot {
+        atomic<uint64_t> check{0}, data{0};
+    };
+    uint64_t mask;
+    unique_ptr<Slot[]> slots;
+};
+
+/*---------------------------------------------------------------
+  SOLVER STATE
+---------------------------------------------------------------*/
+
+// One placement option; key orders by overlap (descending), then
+// centrality rank of the start cell, then direction
+struct Candidate {
+    int r, c, d, overlap;
+    int64_t key;
+};
+
+// Min-heap order on key, so the heap front is the next candidate to try
+inline bool candidateAfter(const Candidate &a, const Candidate &b) { return a.key > b.key; }
+
+// Add to a SolverStats counter of a context; nothing without WORDSEARCH_STATS
+#if WORDSEARCH_STATS
+#define SEARCH_STAT(ctx, field, amount) ((ctx).stats.field += (amount))
+#else
+#define SEARCH_STAT(ctx, field, amount) ((void)0)
+#endif
+
+// State shared by all threads of one solve: the best score so far and the
+// stop flag polled by the search (raised by SolveTimer, to cancel, or once
+// the best reaches goal_score)
+struct SolveShared {
+    atomic<int64_t> best_score{packScore(0, 0, 0)};
+    atomic<bool> stop{false};
+    int64_t goal_score = INT64_MAX;
+
+    // Warm start: placements every worker lays down before searching
+    vector<WordPlacement> fixed;
+
+    // Time-stamped raises of best_score, when log_improvements is set
+    bool log_improvements = false;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    mutex log_lock;
+    vector<SolveImprovement> improvements;
+    unique_ptr<TranspositionTable> table;   // null when disabled
+
+    // Newest best layout for config.progress, when report_progress is set:
+    // published by the thread that found it, taken by the ProgressReporter
+    bool report_progress = false;
+    mutex progress_lock;
+    PuzzleResult progress_best;
+    bool progress_fresh = false;
+};
+
+// Offer a new best layout to the progress reporter; a layout that lost the
+// race against a better one from another thread is dropped
+void publishProgress(SolveShared &shared, const PuzzleResult &best) {
+    lock_guard<mutex> guard(shared.progress_lock);
+    PuzzleResult &snapshot = shared.progress_best;
+    if(resultScore(best) <= resultScore(snapshot)) return;
+    snapshot.grid.assignCells(best.grid);
+    snapshot.placements = best.placements;
+    snapshot.num_required_placed = best.num_required_placed;
+    snapshot.num_placed = best.num_placed;
+    snapshot.total_overlap_score = best.total_overlap_score;
+    shared.progress_fresh = true;
+}
+
+// Passes the newest published layout to config.progress once per interval,
+// from its own thread so the search never waits on the callback; stops
+// (without a last report) when destroyed
+class ProgressReporter {
+public:
+    ProgressReporter(SolveShared &shared, const SolverConfig &config, const vector<string> &words)
+        : timer([this, &shared, &config, &words]() {
+            unique_lock<mutex> guard(lock);
+            auto interval = chrono::milliseconds(max(1, config.progress_interval_ms));
+            while(!wake.wait_for(guard, interval, [this]() { return finished; })) {
+                PuzzleResult report;
+                {
+                    lock_guard<mutex> progress_guard(shared.progress_lock);
+                    if(!shared.progress_fresh) continue;
+                    report = shared.progress_best;
+                    shared.progress_fresh = false;
+                }
+                vector<bool> placed(words.size(), false);
+                for(auto &p : report.placements) placed[p.word_index] = true;
+                for(size_t i = 0; i < words.size(); i++)
+                    (placed[i] ? report.placed_words : report.unplaced_words).push_back(words[i]);
+                config.progress(report);
+            }
+        }) {}
+
+    ~ProgressReporter() {
+        {
+            lock_guard<mutex> guard(lock);
+            finished = true;
+        }
+        wake.notify_all();
+        timer.join();
+    }
+
+private:
+    mutex lock;
+    condition_variable wake;
+    bool finished = false;
+    thread timer;
+};
+
+// Raises stop once the runtime budget is spent, so the search never reads
+// the clock; finishes early when destroyed before the deadline
+class SolveTimer {
+public:
+    SolveTimer(atomic<bool> &stop, int runtime_ms) : timer([this, &stop, runtime_ms]() {
+        unique_lock<mutex> guard(lock);
+        if(!wake.wait_for(guard, chrono::milliseconds(runtime_ms), [this]() { return finished; })) {
+            stop.store(true, memory_order_relaxed);
+            fired = true;
+        }
+    }) {}
+
+    // Whether the deadline has passed and raised stop
+    bool expired() {
+        lock_guard<mutex> guard(lock);
+        return fired;
+    }
+
+    ~SolveTimer() {
+        {
+            lock_guard<mutex> guard(lock);
+            finished = true;
+        }
+        wake.notify_all();
+        timer.join();
+    }
+
+private:
+    mutex lock;
+    condition_variable wake;
+    bool finished = false, fired = false;
+    thread timer;
+};
+
+// Raise the shared best score; true if score beat it
+bool raiseSharedBest(SolveShared &shared, int64_t score, int worker = 0) {
+    int64_t best = shared.best_score.load(memory_order_relaxed);
+    while(score > best)
+        if(shared.best_score.compare_exchange_weak(best, score, memory_order_relaxed)) {
+            if(score >= shared.goal_score) shared.stop.store(true, memory_order_relaxed);
+#if WORDSEARCH_STATS
+            if(shared.log_improvements) {
+                long long elapsed = chrono::duration_cast<chrono::microseconds>(
+                    chrono::steady_clock::now() - shared.start).count();
+                lock_guard<mutex> guard(shared.log_lock);
+                shared.improvements.push_back({elapsed, worker, scoreRequired(score), scorePlaced(score),
+                                               scoreOverlap(score)});
+            }
+#else
+            (void)worker;
+#endif
+            return true;
+        }
+    return false;
+}
+
+// Move recorded for a word that was skipped; placed words record cell * 8 + direction
+const int SKIP_MOVE = -1;
+
+// A subtree to explore, given as the moves for the first words in word order
+struct SubtreeTask {
+    vector<int> moves;
+    vector<int> word_order;   // the donor's order when dynamic ordering rearranges it (else empty)
+};
+
+// Per-worker task deques: owners push and pop at the back, thieves take the
+// oldest (largest) subtrees from the front
+struct SubtreeScheduler {
+    struct WorkDeque {
+        mutex lock;
+        deque<SubtreeTask> tasks;
+    };
+    vector<WorkDeque> deques;
+    atomic<int> pending{0};        // tasks queued or running
+    atomic<int> queued{0};         // tasks sitting in a deque
+    atomic<int> idle_workers{0};
+    int split_depth;
+    // Idle workers sleep here until a task is pushed or the last one finishes
+    mutex wait_lock;
+    condition_variable wake;
+
+    SubtreeScheduler(int workers, int depth) : deques(workers), split_depth(depth) {}
+
+    void push(int worker, SubtreeTask &&task) {
+        pending.fetch_add(1);
+        {
+            lock_guard<mutex> guard(deques[worker].lock);
+            deques[worker].tasks.push_back(move(task));
+        }
+        queued.fetch_add(1);
+        { lock_guard<mutex> guard(wait_lock); }
+        wake.notify_one();
+    }
+
+    bool pop(int worker, SubtreeTask &task) {
+        lock_guard<mutex> guard(deques[worker].lock);
+        if(deques[worker].tasks.empty()) return false;
+        task = move(deques[worker].tasks.back());
+        deques[worker].tasks.pop_back();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    bool steal(int thief, SubtreeTask &task) {
+        for(int i = 1; i < (int)deques.size(); i++) {
+            WorkDeque &victim = deques[(thief + i) % deques.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if(victim.tasks.empty()) continue;
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    // A popped task is done; the last one wakes everyone to exit
+    void finish() {
+        if(pending.fetch_sub(1) != 1) return;
+        { lock_guard<mutex> guard(wait_lock); }
+        wake.notify_all();
+    }
+
+    void waitForWork() {
+        unique_lock<mutex> guard(wait_lock);
+        wake.wait(guard, [&] { return queued.load() > 0 || pending.load() == 0; });
+    }
+};
+
+struct SolveContext;
+typedef void (*SearchFunction)(SolveContext &ctx, int current_index, Grid &grid, int current_overlap);
+
+// Everything shared by the nodes of one solve; its containers live in the
+// worker's scratch arena
+struct SolveContext {
+    const vector<string> &words;
+    pmr::vector<int> word_order;
+    WordOrdering ordering = ORDER_LENGTH;   // this worker's, never ORDER_MIXED
+    pmr::vector<int> order_key;             // static ordering key per word, higher goes first
+    pmr::vector<WordPattern> patterns;
+    MatchRunKernel kernel = nullptr;
+    bool use_bitboards = false;         // ENGINE_BITBOARD on a board that fits
+    SearchFunction search = nullptr;    // solvePuzzleRecursively for this board size
+
+    pmr::vector<WordPlacement> current_placements;
+    pmr::vector<bool> used_flags;
+    int required_count = 0;     // the first required_count words in word_order are required
+    int required_placed = 0;
+    pmr::vector<int> witness;   // last placement (cell * 8 + direction) seen to fit each word, or -1
+    pmr::vector<int> undo_log;
+    PuzzleResult &best_result;
+
+    // Best score and stop flag across all search threads; best_result only
+    // records states that raised the best score
+    SolveShared *shared = nullptr;
+
+    // This worker's id (also its scheduler slot in subtree mode) and the
+    // moves from the root
+    SubtreeScheduler *scheduler = nullptr;
+    int worker_id = 0;
+    pmr::vector<int> moves;
+
+    // Rank of each cell by distance from the centre (ties by row, col), computed once
+    pmr::vector<int> cell_rank;
+    int direction_rank[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    // Candidate buffers, and grids for the copy engine, reused per recursion depth
+    pmr::vector<pmr::vector<Candidate>> candidate_pool;
+    pmr::vector<Grid> grid_pool;
+    pmr::vector<int> free_fits;     // dynamic ordering: empty-cell placements per word length
+
+    const SolverConfig *config = nullptr;
+    int rows = 0, cols = 0;
+
+    // Zobrist hash of the grid under each board symmetry, kept up to date
+    // while a transposition table is in use; order_salt tells apart workers
+    // whose word orders differ, and under dynamic ordering consumed_hash
+    // the sets of words already placed or skipped
+    uint64_t symmetry_hash[8] = {};
+    int symmetry_count = 4;
+    uint64_t order_salt = 0, consumed_hash = 0;
+
+    SolveContext(const vector<string> &w, PuzzleResult &best, pmr::memory_resource *memory)
+        : words(w), word_order(memory), order_key(memory), patterns(memory), current_placements(memory),
+          used_flags(memory), witness(memory), undo_log(memory), best_result(best), moves(memory), cell_rank(memory),
+          candidate_pool(memory), grid_pool(memory), free_fits(memory) {}
+
+    // Warm start: the fixed placements at the front of current_placements,
+    // the required words and overlap among them, and the hashes with them on
+    uint64_t base_hash[8] = {};
+    int base_placed = 0, base_required = 0, base_overlap = 0;
+
+    // Nodes entered so far, and an optional cap on them (0: none)
+    long long nodes = 0, node_limit = 0;
+    SolverStats stats;          // this worker's counters; improvements stay empty
+
+    bool stopRequested() const {
+        return shared->stop.load(memory_order_relaxed) || (node_limit && nodes >= node_limit);
+    }
+
+    int64_t candidateKey(int r, int c, int d, int overlap) const {
+        return ((int64_t)((1 << 30) - overlap) << 32) | ((int64_t)cell_rank[r * cols + c] * 8 + direction_rank[d]);
+    }
+
+    // Fold the cells a placement is about to fill into the symmetry hashes;
+    // call before writing the word
+    void hashPlacement(const Grid &grid, const string &word, int r, int c, int dr, int dc) {
+        for(int i = 0; i < (int)word.size(); i++, r += dr, c += dc)
+            if(grid.at(r, c) == '.')
+                for(int s = 0; s < symmetry_count; s++) symmetry_hash[s] ^= cellKey(s, r, c, rows, cols, word[i]);
+    }
+
+    // Key of (grid up to symmetry, next word index); mirrored boards share it
+    uint64_t stateHash(int current_index) const {
+        uint64_t canonical = *min_element(symmetry_hash, symmetry_hash + symmetry_count);
+        return mix64(canonical ^ mix64(((uint64_t)current_index << 32) ^ order_salt ^ consumed_hash));
+    }
+
+    // Under dynamic ordering, mark word_index placed or skipped (or, again, back)
+    void toggleConsumed(int word_index) {
+        if(ordering == ORDER_DYNAMIC) consumed_hash ^= mix64(word_index + 1);
+    }
+};
+
+/*---------------------------------------------------------------
+  SEARCH BOUNDS
+---------------------------------------------------------------*/
+
+// True while the word still fits somewhere on the board. Filling cells only
+// removes placements, so the last fit found is remembered and tried first
+template<int ROWS, int COLS>
+bool stillPlaceable(SolveContext &ctx, const Grid &grid, const GridShape<ROWS, COLS> &shape, int word_index) {
+    const string &word = ctx.words[word_index];
+    int overlap;
+    int &witness = ctx.witness[word_index];
+    if(witness >= 0 &&
+       canPlaceWord(grid, word, shape.index(witness / 8 / shape.cols(), witness / 8 % shape.cols()),
+                    shape.step(witness % 8), overlap))
+        return true;
+    for(int r = 0; r < shape.rows(); r++)
+        for(int c = 0; c < shape.cols(); c++)
+            for(int d = 0; d < DIRECTION_COUNT; d++)
+                if(canPlaceWord(grid, word, shape.index(r, c), shape.step(d), overlap)) {
+                    witness = (r * shape.cols() + c) * 8 + d;
+                    return true;
+                }
+    return false;
+}
+
+// Most overlap the words from current_index on can still add: each letter
+// of a word can only land on a matching letter already on the board or
+// written by an earlier one of those words. Dynamic ordering has not fixed
+// which of them come earlier, so there any of the others may have written it
+int overlapBound(const SolveContext &ctx, const Grid &grid, int current_index) {
+    int available[26];
+    for(int ch = 0; ch < 26; ch++) available[ch] = grid.letter_cells[ch].size();
+    int bound = 0;
+    if(ctx.ordering == ORDER_DYNAMIC) {
+        for(int i = current_index; i < (int)ctx.word_order.size(); i++)
+            for(const LetterBits &b : ctx.patterns[ctx.word_order[i]].forward_bits) available[b.letter] += b.count;
+        for(int i = current_index; i < (int)ctx.word_order.size(); i++)
+            for(const LetterBits &b : ctx.patterns[ctx.word_order[i]].forward_bits)
+                bound += min(b.count, available[b.letter] - b.count);
+        return bound;
+    }
+    for(int i = current_index; i < (int)ctx.word_order.size(); i++) {
+        const WordPattern &pattern = ctx.patterns[ctx.word_order[i]];
+        for(const LetterBits &b : pattern.forward_bits) bound += min(b.count, available[b.letter]);
+        for(const LetterBits &b : pattern.forward_bits) available[b.letter] += b.count;
+    }
+    return bound;
+}
+
+/*---------------------------------------------------------------
+  DYNAMIC WORD ORDERING
+---------------------------------------------------------------*/
+
+// Placements a word of each length has over empty cells only, from the
+// maximal runs of empty cells along every line (both ways round)
+template<int ROWS, int COLS>
+void countFreeFits(const Grid &grid, const GridShape<ROWS, COLS> &shape, pmr::vector<int> &free_fits) {
+    fill(free_fits.begin(), free_fits.end(), 0);
+    int max_len = free_fits.size() - 1;
+    for(int d : {0, 2, 4, 5}) {
+        int step = shape.step(d);
+        for(int r = 0; r < shape.rows(); r++)
+            for(int c = 0; c < shape.cols(); c++) {
+                int pos = shape.index(r, c);
+                if(grid.cells[pos] != '.' || grid.cells[pos - step] == '.') continue;
+                int run = 0;
+                while(grid.cells[pos + run * step] == '.') run++;
+                for(int len = 1; len <= min(run, max_len); len++) free_fits[len] += 2 * (run - len + 1);
+            }
+    }
+}
+
+// Placements of word left on the board that cross a filled cell, found from
+// its letters' cells as in candidate generation; counting stops at limit
+template<int ROWS, int COLS>
+int countCrossingFits(const Grid &grid, const GridShape<ROWS, COLS> &shape, const string &word, int limit) {
+    int count = 0, word_len = word.size();
+    for(int i = 0; i < word_len; i++)
+        for(int cell : grid.letter_cells[word[i] - 'A'])
+            for(int d = 0; d < DIRECTION_COUNT; d++) {
+                int r = shape.rowOf(cell) - i * DIR_ROW[d], c = shape.colOf(cell) - i * DIR_COL[d];
+                if(!shape.contains(r, c)) continue;
+                int pos = shape.index(r, c), step = shape.step(d);
+                bool first_anchor = true;
+                for(int j = 0; j < i && first_anchor; j++)
+                    if(grid.cells[pos + j * step] == word[j]) first_anchor = false;
+                int overlap_val;
+                if(first_anchor && canPlaceWord(grid, word, pos, step, overlap_val) && ++count >= limit) return count;
+            }
+    return count;
+}
+
+const int DYNAMIC_ORDER_WINDOW = 24;
+
+// Most constrained next: move to current_index the remaining word of its
+// group (required words until those run out, then the rest) with the
+// fewest placements left, ties going to the earlier one in the order. A
+// word's count stops as soon as it cannot beat the best so far, and a word
+// that fits nowhere is taken at once
+template<int ROWS, int COLS>
+void pickMostConstrained(SolveContext &ctx, const Grid &grid, const GridShape<ROWS, COLS> &shape,
+                         int current_index) {
+    int end = current_index < ctx.required_count ? ctx.required_count : ctx.word_order.size();
+    end = min(end, current_index + DYNAMIC_ORDER_WINDOW);
+    if(end - current_index < 2) return;
+    countFreeFits(grid, shape, ctx.free_fits);
+    int max_len = ctx.free_fits.size() - 1;
+    int best_at = current_index, best_count = INT_MAX;
+    for(int i = current_index; i < end && best_count > 0; i++) {
+        const string &word = ctx.words[ctx.word_order[i]];
+        int count = (int)word.size() <= max_len ? ctx.free_fits[word.size()] : 0;
+        if(count >= best_count) continue;
+        count += countCrossingFits(grid, shape, word, best_count - count);
+        if(count < best_count) {
+            best_count = count;
+            best_at = i;
+        }
+    }
+    rotate(ctx.word_order.begin() + current_index, ctx.word_order.begin() + best_at,
+           ctx.word_order.begin() + best_at + 1);
+}
+
+/*---------------------------------------------------------------
+  RECURSIVE BACKTRACKING ALGORITHM
+---------------------------------------------------------------*/
+
+// Hand the less promising half of a node's candidate heap to idle workers
+// as subtree tasks. A heap's back half is not its worst half, so sort by key
+// first (donation is rare) and rebuild the heap from the half that stays
+void donateCandidates(SolveContext &ctx, pmr::vector<Candidate> &candidates) {
+    sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) { return a.key < b.key; });
+    size_t keep = (candidates.size() + 1) / 2;
+    for(size_t i = keep; i < candidates.size(); i++) {
+        SubtreeTask task;
+        task.moves.assign(ctx.moves.begin(), ctx.moves.end());
+        task.moves.push_back((candidates[i].r * ctx.cols + candidates[i].c) * 8 + candidates[i].d);
+        if(ctx.ordering == ORDER_DYNAMIC) task.word_order.assign(ctx.word_order.begin(), ctx.word_order.end());
+        ctx.scheduler->push(ctx.worker_id, move(task));
+    }
+    candidates.resize(keep);
+    make_heap(candidates.begin(), candidates.end(), candidateAfter);
+}
+
+template<int ROWS, int COLS>
+void solvePuzzleRecursively(SolveContext &ctx, int current_index, Grid& grid, int current_overlap) {
+
+    if(ctx.stopRequested()) return;
+    ctx.nodes++;
+    SEARCH_STAT(ctx, nodes, 1);
+#if WORDSEARCH_STATS
+    ctx.stats.peak_depth = max(ctx.stats.peak_depth, current_index);
+#endif
+    const GridShape<ROWS, COLS> shape(grid);
+
+    PuzzleResult &best_result = ctx.best_result;
+    int placed_count = ctx.current_placements.size();
+
+    // Update best solution
+    int64_t score = packScore(ctx.required_placed, placed_count, current_overlap);
+    if(raiseSharedBest(*ctx.shared, score, ctx.worker_id)) {
+        best_result.num_required_placed = ctx.required_placed;
+        best_result.num_placed = placed_count;
+        best_result.total_overlap_score = current_overlap;
+        best_result.grid.assignCells(grid);
+        best_result.placements.assign(ctx.current_placements.begin(), ctx.current_placements.end());
+        if(ctx.shared->report_progress) publishProgress(*ctx.shared, best_result);
+    }
+
+    if(current_index >= (int)ctx.word_order.size()) return;
+
+    // Stop if no chance to improve best (across all threads). The bound
+    // assumes every remaining word gets placed, except required ones that no
+    // longer fit anywhere; on a tie in those counts it takes the letter
+    // multiset overlap bound
+    int64_t best = ctx.shared->best_score.load(memory_order_relaxed);
+    int remaining = ctx.word_order.size() - current_index;
+    int required_left = max(0, ctx.required_count - current_index);
+    if(packScore(ctx.required_placed + required_left, placed_count + remaining, 0) < (best & ~0xFFFFFFFFLL)) {
+        SEARCH_STAT(ctx, prunes_count, 1);
+        return;
+    }
+    int unplaceable = 0;
+    for(int i = current_index; i < ctx.required_count; i++)
+        if(!stillPlaceable(ctx, grid, shape, ctx.word_order[i])) unplaceable++;
+    int64_t count_bound = packScore(ctx.required_placed + required_left - unplaceable,
+                                    placed_count + remaining - unplaceable, 0);
+    if(count_bound < (best & ~0xFFFFFFFFLL)) {
+        SEARCH_STAT(ctx, prunes_required, 1);
+        return;
+    }
+    if(count_bound == (best & ~0xFFFFFFFFLL) &&
+       current_overlap + overlapBound(ctx, grid, current_index) <= scoreOverlap(best)) {
+        SEARCH_STAT(ctx, prunes_overlap, 1);
+        return;
+    }
+
+    // Skip states already reached, possibly mirrored, with at least this score
+    TranspositionTable *table = ctx.shared->table.get();
+    if(table && table->dominated(ctx.stateHash(current_index), score)) {
+        SEARCH_STAT(ctx, prunes_transposition, 1);
+        return;
+    }
+
+    if(ctx.ordering == ORDER_DYNAMIC) pickMostConstrained(ctx, grid, shape, current_index);
+    int word_index = ctx.word_order[current_index];
+    const string &current_word = ctx.words[word_index];
+    const WordPattern &pattern = ctx.patterns[word_index];
+    int word_len = current_word.size();
+    pmr::vector<Candidate> &candidates = ctx.candidate_pool[current_index];
+
+    auto fitsAt = [&](int r, int c, int d, int &overlap_val) {
+        if(ctx.use_bitboards || ctx.kernel) {
+            int er = r + (word_len - 1) * DIR_ROW[d], ec = c + (word_len - 1) * DIR_COL[d];
+            if(!shape.contains(er, ec)) return false;
+            if(ctx.use_bitboards) return canPlaceWordBitboard(grid, pattern, r, c, er, ec, d, overlap_val);
+            return canPlaceWordVector(ctx.kernel, grid, pattern, r, c, er, ec, d, overlap_val);
+        }
+        return canPlaceWord(grid, current_word, shape.index(r, c), shape.step(d), overlap_val);
+    };
+
+    // Recursive placement attempts, popping candidates lazily in key order so a
+    // node only pays for the ones it explores; returns false once time runs out
+    auto exploreCandidates = [&]() {
+        SEARCH_STAT(ctx, candidates_generated, candidates.size());
+        make_heap(candidates.begin(), candidates.end(), candidateAfter);
+        while(!candidates.empty()) {
+            if(ctx.stopRequested()) return false;
+            pop_heap(candidates.begin(), candidates.end(), candidateAfter);
+            Candidate cand = candidates.back();
+            candidates.pop_back();
+            SEARCH_STAT(ctx, candidates_explored, 1);
+
+            // Subtree mode: share siblings while some worker has nothing to do
+            if(ctx.scheduler && current_index < ctx.scheduler->split_depth && candidates.size() > 1 &&
+               ctx.scheduler->idle_workers.load(memory_order_relaxed) > 0)
+                donateCandidates(ctx, candidates);
+
+            uint64_t saved_hash[8];
+            if(table) {
+                copy(begin(ctx.symmetry_hash), end(ctx.symmetry_hash), saved_hash);
+                ctx.hashPlacement(grid, current_word, cand.r, cand.c, DIR_ROW[cand.d], DIR_COL[cand.d]);
+            }
+            ctx.current_placements.push_back({word_index, cand.r, cand.c, DIR_ROW[cand.d], DIR_COL[cand.d]});
+            ctx.used_flags[word_index] = true;
+            ctx.toggleConsumed(word_index);
+            if(current_index < ctx.required_count) ctx.required_placed++;
+            ctx.moves.push_back((cand.r * shape.cols() + cand.c) * 8 + cand.d);
+
+            // Overlap from canPlaceWord is exactly the score delta of this placement
+            int pos = shape.index(cand.r, cand.c), step = shape.step(cand.d);
+            if(ctx.config->engine == ENGINE_COPY) {
+                Grid &new_grid = ctx.grid_pool[current_index];
+                new_grid = grid;
+                placeWord(new_grid, current_word, pos, step);
+                solvePuzzleRecursively<ROWS, COLS>(ctx, current_index + 1, new_grid, current_overlap + cand.overlap);
+            } else {
+                size_t undo_mark = ctx.undo_log.size();
+                placeWordWithUndo(grid, current_word, pos, step, ctx.undo_log);
+                solvePuzzleRecursively<ROWS, COLS>(ctx, current_index + 1, grid, current_overlap + cand.overlap);
+                undoPlacement(grid, ctx.undo_log, undo_mark);
+            }
+
+            ctx.moves.pop_back();
+            if(current_index < ctx.required_count) ctx.required_placed--;
+            ctx.toggleConsumed(word_index);
+            ctx.used_flags[word_index] = false;
+            ctx.current_placements.pop_back();
+            if(table) copy(begin(saved_hash), end(saved_hash), ctx.symmetry_hash);
+        }
+        return true;
+    };
+
+    // Overlapping placements first: anchor each letter of the word on the
+    // cells already holding it, via the grid's letter index
+    candidates.clear();
+    for(int i = 0; i < word_len; i++)
+        for(int cell : grid.letter_cells[current_word[i] - 'A'])
+            for(int d = 0; d < DIRECTION_COUNT; d++) {
+                int r = shape.rowOf(cell) - i * DIR_ROW[d], c = shape.colOf(cell) - i * DIR_COL[d];
+                if(!shape.contains(r, c)) continue;
+
+                // Generate each placement once, from its first overlapping letter
+                int pos = shape.index(r, c), step = shape.step(d);
+                bool first_anchor = true;
+                for(int j = 0; j < i && first_anchor; j++)
+                    if(grid.cells[pos + j * step] == current_word[j]) first_anchor = false;
+
+                int overlap_val;
+                if(first_anchor && fitsAt(r, c, d, overlap_val))
+                    candidates.push_back({r, c, d, overlap_val, ctx.candidateKey(r, c, d, overlap_val)});
+            }
+    if(!exploreCandidates()) return;
+
+    // Non-overlapping placements only once the overlapping ones run out; the
+    // grid's empty runs, kept up to date as words come and go, answer these
+    // without a placement check
+    if(grid.hasFreeRuns()) grid.syncFreeRuns();
+    const uint16_t *free_runs = grid.hasFreeRuns() ? grid.free_runs.data() : nullptr;
+    for(int r = 0; r < shape.rows(); r++)
+        for(int c = 0; c < shape.cols(); c++)
+            for(int d = 0; d < DIRECTION_COUNT; d++) {
+                int overlap_val;
+                bool fits;
+                if(!free_runs) fits = fitsAt(r, c, d, overlap_val) && overlap_val == 0;
+                else if(FREE_RUN_FORWARD[d]) fits = free_runs[shape.index(r, c) * 4 + FREE_RUN_LANE[d]] >= word_len;
+                else {
+                    int er = r + (word_len - 1) * DIR_ROW[d], ec = c + (word_len - 1) * DIR_COL[d];
+                    fits = shape.contains(er, ec) && free_runs[shape.index(er, ec) * 4 + FREE_RUN_LANE[d]] >= word_len;
+                }
+                if(fits) candidates.push_back({r, c, d, 0, ctx.candidateKey(r, c, d, 0)});
+            }
+    if(!exploreCandidates()) return;
+
+    // Optionally skip this word
+    if(!ctx.stopRequested()) {
+        ctx.moves.push_back(SKIP_MOVE);
+        ctx.toggleConsumed(word_index);
+        solvePuzzleRecursively<ROWS, COLS>(ctx, current_index + 1, grid, current_overlap);
+        ctx.toggleConsumed(word_index);
+        ctx.moves.pop_back();
+    }
+}
+
+// Search entry for the board size: an instance specialized for the common
+// board sizes, the runtime-sized one otherwise
+SearchFunction selectSearch(int rows, int cols) {
+    if(rows == 10 && cols == 10) return solvePuzzleRecursively<10, 10>;
+    if(rows == 15 && cols == 15) return solvePuzzleRecursively<15, 15>;
+    if(rows == 20 && cols == 20) return solvePuzzleRecursively<20, 20>;
+    return solvePuzzleRecursively<0, 0>;
+}
+
+/*---------------------------------------------------------------
+  SOLVER WORKERS
+---------------------------------------------------------------*/
+
+// Static ordering key of every word: its length, or for ORDER_ISOLATED its
+// length plus its letters that no other word in the list contains
+void buildOrderKeys(const vector<string>& words, WordOrdering ordering, pmr::vector<int> &order_key) {
+    int containing[26] = {};
+    for(auto &w : words) {
+        bool seen[26] = {};
+        for(char ch : w) seen[ch - 'A'] = true;
+        for(int ch = 0; ch < 26; ch++) containing[ch] += seen[ch];
+    }
+    order_key.clear();
+    for(auto &w : words) {
+        int key = w.size();
+        if(ordering == ORDER_ISOLATED)
+            for(char ch : w) key += containing[ch - 'A'] == 1;
+        order_key.push_back(key);
+    }
+}
+
+// Required words first, each group by descending order key. With an rng the
+// keys get a little noise so nearly-equal words swap places at random
+void buildWordOrder(const pmr::vector<int>& order_key, const vector<bool>& required_flags, mt19937_64 *rng,
+                    pmr::vector<int> &word_order) {
+    word_order.clear();
+    uniform_int_distribution<int> noise(0, 5);
+    for(int pass = 0; pass < 2; ++pass) {
+        vector<pair<int,int>> tmp;
+        for(int i = 0; i < (int)order_key.size(); ++i)
+            if((pass == 0) == required_flags[i])
+                tmp.push_back({order_key[i] * (rng ? 4 : 1) + (rng ? noise(*rng) : 0), i});
+        if(rng) shuffle(tmp.begin(), tmp.end(), *rng);
+        if(rng) stable_sort(tmp.begin(), tmp.end(), [](auto &a, auto &b) { return a.first > b.first; });
+        else sort(tmp.begin(), tmp.end(), greater<>());
+        for(auto &p : tmp) word_order.push_back(p.second);
+    }
+}
+
+// Word ordering of one worker: config.ordering, or its share of ORDER_MIXED
+WordOrdering workerOrdering(const SolverConfig &config, int worker_id) {
+    if(config.ordering != ORDER_MIXED) return config.ordering;
+    static const WordOrdering MIXED[3] = {ORDER_LENGTH, ORDER_DYNAMIC, ORDER_ISOLATED};
+    return MIXED[worker_id % 3];
+}
+
+// Per-worker solver setup. With an rng the word order and the cell and
+// direction tie-breaking are perturbed by its seed
+void initSolveContext(SolveContext &ctx, const vector<bool>& required_flags, const SolverConfig &config,
+                      WordOrdering ordering, mt19937_64 *perturb) {
+    int rows = config.rows, cols = config.cols;
+    ctx.config = &config;
+    ctx.rows = rows;
+    ctx.cols = cols;
+    ctx.use_bitboards = config.engine == ENGINE_BITBOARD && rows <= GRID_BITBOARD_MAX && cols <= GRID_BITBOARD_MAX;
+    ctx.kernel = config.use_simd && !ctx.use_bitboards ? selectMatchKernel() : nullptr;
+    ctx.search = selectSearch(rows, cols);
+    ctx.symmetry_count = symmetryCount(rows, cols);
+    ctx.ordering = ordering;
+    buildOrderKeys(ctx.words, ordering, ctx.order_key);
+    buildWordOrder(ctx.order_key, required_flags, perturb, ctx.word_order);
+    pmr::memory_resource *memory = ctx.word_order.get_allocator().resource();
+    ctx.patterns.reserve(ctx.words.size());
+    for(auto &w : ctx.words) ctx.patterns.push_back(makeWordPattern(w, memory));
+    ctx.used_flags.assign(ctx.words.size(), false);
+    ctx.witness.assign(ctx.words.size(), -1);
+    ctx.required_count = count(required_flags.begin(), required_flags.end(), true);
+    ctx.candidate_pool.resize(ctx.word_order.size());
+    if(config.engine == ENGINE_COPY) ctx.grid_pool.resize(ctx.word_order.size());
+    if(ordering == ORDER_DYNAMIC) ctx.free_fits.assign(max(rows, cols) + 1, 0);
+
+    // Centrality ranks: distance from the centre, ties broken by row then col
+    // (or at random when perturbed)
+    vector<pair<int,int>> cell_order;
+    for(int r = 0; r < rows; r++)
+        for(int c = 0; c < cols; c++)
+            cell_order.push_back({abs(r - rows/2) + abs(c - cols/2), r * cols + c});
+    if(perturb) {
+        shuffle(cell_order.begin(), cell_order.end(), *perturb);
+        stable_sort(cell_order.begin(), cell_order.end(), [](auto &a, auto &b) { return a.first < b.first; });
+        shuffle(begin(ctx.direction_rank), end(ctx.direction_rank), *perturb);
+    } else {
+        sort(cell_order.begin(), cell_order.end());
+    }
+    ctx.cell_rank.resize(rows * cols);
+    for(int i = 0; i < (int)cell_order.size(); i++) ctx.cell_rank[cell_order[i].second] = i;
+}
+
+// Lay the warm-start placements onto the worker's blank grid as its fixed
+// base and drop their words from the search order
+void applyFixedPlacements(SolveContext &ctx, Grid &grid, const vector<WordPlacement> &fixed,
+                          const vector<bool> &required_flags) {
+    if(fixed.empty()) return;
+    for(auto &p : fixed) {
+        const string &word = ctx.words[p.word_index];
+        int pos = grid.index(p.row, p.col), step = grid.step(p.delta_row, p.delta_col), overlap_val;
+        canPlaceWord(grid, word, pos, step, overlap_val);
+        if(ctx.shared->table) ctx.hashPlacement(grid, word, p.row, p.col, p.delta_row, p.delta_col);
+        placeWord(grid, word, pos, step);
+        ctx.current_placements.push_back(p);
+        ctx.used_flags[p.word_index] = true;
+        ctx.base_required += required_flags[p.word_index];
+        ctx.base_overlap += overlap_val;
+    }
+    ctx.base_placed = fixed.size();
+    ctx.required_placed = ctx.base_required;
+    copy(begin(ctx.symmetry_hash), end(ctx.symmetry_hash), ctx.base_hash);
+    ctx.word_order.erase(remove_if(ctx.word_order.begin(), ctx.word_order.end(),
+                                   [&](int w) { return ctx.used_flags[w]; }),
+                         ctx.word_order.end());
+    ctx.required_count = count_if(ctx.word_order.begin(), ctx.word_order.end(),
+                                  [&](int w) { return required_flags[w]; });
+}
+
+// Each worker's share of config.node_budget, or 0 when the solve is timed
+long long workerNodeBudget(const SolverConfig &config) {
+    if(config.node_budget <= 0) return 0;
+    return max(1LL, config.node_budget / max(1, config.threads));
+}
+
+// One portfolio member. Worker 0 runs the default deterministic search; the
+// others perturb word order and tie-breaking with their own seed, and under
+// ORDER_MIXED may also order the words by another strategy
+void runSolverWorker(int worker_id, const vector<string>& words, const vector<bool>& required_flags,
+                     const SolverConfig &config, SolveShared &shared, PuzzleResult &result) {
+    mt19937_64 rng(0x9E3779B97F4A7C15ULL * (uint64_t)worker_id);
+    ScratchArena scratch;
+    SolveContext ctx(words, result, scratch.resource());
+    initSolveContext(ctx, required_flags, config, workerOrdering(config, worker_id),
+                     worker_id > 0 ? &rng : nullptr);
+    ctx.shared = &shared;
+    ctx.worker_id = worker_id;
+    ctx.order_salt = worker_id;
+    ctx.node_limit = workerNodeBudget(config);
+
+    Grid grid(config.rows, config.cols, ctx.kernel != nullptr, ctx.use_bitboards, true);
+    result.grid.assignCells(grid);
+    applyFixedPlacements(ctx, grid, shared.fixed, required_flags);
+    ctx.search(ctx, 0, grid, ctx.base_overlap);
+    result.stats = ctx.stats;
+}
+
+// Replay a task's moves onto the worker grid (blank but for any fixed
+// placements) in the donor's word order, search below it, then roll back
+void runSubtreeTask(SolveContext &ctx, Grid &grid, const SubtreeTask &task) {
+    if(!task.word_order.empty()) ctx.word_order.assign(task.word_order.begin(), task.word_order.end());
+    int overlap = ctx.base_overlap;
+    for(int depth = 0; depth < (int)task.moves.size(); depth++) {
+        int move = task.moves[depth];
+        ctx.moves.push_back(move);
+        ctx.toggleConsumed(ctx.word_order[depth]);
+        if(move == SKIP_MOVE) continue;
+
+        int word_index = ctx.word_order[depth];
+        const string &word = ctx.words[word_index];
+        int r = move / 8 / grid.cols, c = move / 8 % grid.cols;
+        int dr = DIRECTIONS[move % 8].first, dc = DIRECTIONS[move % 8].second;
+        int pos = grid.index(r, c), step = grid.step(dr, dc);
+        int overlap_val;
+        canPlaceWord(grid, word, pos, step, overlap_val);
+        if(ctx.shared->table) ctx.hashPlacement(grid, word, r, c, dr, dc);
+        placeWordWithUndo(grid, word, pos, step, ctx.undo_log);
+        overlap += overlap_val;
+        ctx.current_placements.push_back({word_index, r, c, dr, dc});
+        ctx.used_flags[word_index] = true;
+        if(depth < ctx.required_count) ctx.required_placed++;
+    }
+
+    ctx.search(ctx, task.moves.size(), grid, overlap);
+
+    undoPlacement(grid, ctx.undo_log, 0);
+    copy(begin(ctx.base_hash), end(ctx.base_hash), ctx.symmetry_hash);
+    ctx.consumed_hash = 0;
+    ctx.required_placed = ctx.base_required;
+    ctx.current_placements.resize(ctx.base_placed);
+    ctx.moves.clear();
+    fill(ctx.used_flags.begin(), ctx.used_flags.end(), false);
+    for(auto &p : ctx.current_placements) ctx.used_flags[p.word_index] = true;
+}
+
+// One subtree-mode worker: run own tasks newest first, steal when out of
+// work (sleeping until some is pushed), and stop once no task is queued or
+// running anywhere
+void runSubtreeWorker(int worker_id, const vector<string>& words, const vector<bool>& required_flags,
+                      const SolverConfig &config, SolveShared &shared, SubtreeScheduler &scheduler,
+                      PuzzleResult &result) {
+    ScratchArena scratch;
+    SolveContext ctx(words, result, scratch.resource());
+    initSolveContext(ctx, required_flags, config, workerOrdering(config, 0), nullptr);
+    ctx.shared = &shared;
+    ctx.scheduler = &scheduler;
+    ctx.worker_id = worker_id;
+    ctx.node_limit = workerNodeBudget(config);
+
+    Grid grid(config.rows, config.cols, ctx.kernel != nullptr, ctx.use_bitboards, true);
+    result.grid.assignCells(grid);
+    applyFixedPlacements(ctx, grid, shared.fixed, required_flags);
+
+    bool idle = false;
+    SubtreeTask task;
+    while(scheduler.pending.load() > 0) {
+        if(scheduler.pop(worker_id, task) || scheduler.steal(worker_id, task)) {
+            if(idle) { idle = false; scheduler.idle_workers.fetch_sub(1); }
+            runSubtreeTask(ctx, grid, task);
+            scheduler.finish();
+        } else {
+            if(!idle) { idle = true; scheduler.idle_workers.fetch_add(1); }
+            scheduler.waitForWork();
+        }
+    }
+    if(idle) scheduler.idle_workers.fetch_sub(1);
+    result.stats = ctx.stats;
+}
+
+/*---------------------------------------------------------------
+  LARGE NEIGHBOURHOOD SEARCH
+---------------------------------------------------------------*/
+
+// One repair search may enter LNS_REPAIR_NODES nodes; it gets the removed
+// words, every unplaced required word and up to LNS_EXTRA_WORDS other
+// unplaced ones. A destroy step removes at most LNS_MAX_REMOVED placements
+const long long LNS_REPAIR_NODES = 200;
+const int LNS_EXTRA_WORDS = 6;
+const int LNS_MAX_REMOVED = 8;
+
+// Annealing energy: a required word outweighs everything else and a placed
+// word is worth LNS_WORD_WEIGHT overlaps. The temperature falls linearly from
+// LNS_START_TEMPERATURE to zero at the deadline (or as the node budget runs out)
+const double LNS_WORD_WEIGHT = 8.0;
+const double LNS_START_TEMPERATURE = 2.0;
+
+double lnsEnergy(int64_t score) {
+    return scoreRequired(score) * 1e6 + scorePlaced(score) * LNS_WORD_WEIGHT + scoreOverlap(score);
+}
+
+// Write placements onto a copy of the blank grid and score them; the overlap
+// is every letter written minus the cells they cover
+int64_t layPlacements(const SolveContext &ctx, const Grid &blank, Grid &grid, const vector<WordPlacement> &placements,
+                      const vector<bool> &required_flags) {
+    grid = blank;
+    int letters = 0, required = 0, filled = 0;
+    for(auto &p : placements) {
+        const string &word = ctx.words[p.word_index];
+        placeWord(grid, word, grid.index(p.row, p.col), grid.step(p.delta_row, p.delta_col));
+        letters += word.size();
+        required += required_flags[p.word_index];
+    }
+    for(auto &cells : grid.letter_cells) filled += cells.size();
+    return packScore(required, placements.size(), letters - filled);
+}
+
+// Re-insert free_words around the kept placements already on grid with a
+// node-limited DFS. Returns the best score found; ctx.best_result then holds
+// its placements (the kept ones alone when nothing beat them)
+int64_t repairPlacements(SolveContext &ctx, Grid &grid, const vector<WordPlacement> &kept, int64_t kept_score,
+                         vector<int> &free_words, const vector<bool> &required_flags, mt19937_64 &rng) {
+    // Same order as the full search: required first, higher order key first, ties at random
+    shuffle(free_words.begin(), free_words.end(), rng);
+    stable_sort(free_words.begin(), free_words.end(), [&](int a, int b) {
+        if(required_flags[a] != required_flags[b]) return (bool)required_flags[a];
+        return ctx.order_key[a] > ctx.order_key[b];
+    });
+    ctx.word_order.assign(free_words.begin(), free_words.end());
+    ctx.required_count = count_if(free_words.begin(), free_words.end(), [&](int w) { return required_flags[w]; });
+    ctx.required_placed = scoreRequired(kept_score);
+    ctx.current_placements.assign(kept.begin(), kept.end());
+    fill(ctx.used_flags.begin(), ctx.used_flags.end(), false);
+    for(auto &p : kept) ctx.used_flags[p.word_index] = true;
+    ctx.nodes = 0;
+    ctx.node_limit = LNS_REPAIR_NODES;
+
+    PuzzleResult &best = ctx.best_result;
+    best.placements = kept;
+    SolveShared local;
+    local.best_score = kept_score;
+    ctx.shared = &local;
+    ctx.search(ctx, 0, grid, scoreOverlap(kept_score));
+    return local.best_score.load();
+}
+
+// One LNS member: start from the DFS's greedy first descent, then repeatedly
+// tear out a window of the board or a random handful of placements and
+// repair it. Moves are accepted by annealing on lnsEnergy; the best layout
+// seen only ever improves, and is what the worker reports
+void runLnsWorker(int worker_id, const vector<string>& words, const vector<bool>& required_flags,
+                  const SolverConfig &config, SolveShared &shared, PuzzleResult &result) {
+    mt19937_64 rng(0x9E3779B97F4A7C15ULL * (uint64_t)(worker_id + 1));
+    int rows = config.rows, cols = config.cols;
+    ScratchArena scratch;
+    PuzzleResult repair;
+    SolveContext ctx(words, repair, scratch.resource());
+    initSolveContext(ctx, required_flags, config, workerOrdering(config, worker_id), nullptr);
+    Grid blank(rows, cols, ctx.kernel != nullptr, false, true);
+    Grid grid = blank, laid;
+    result.grid.assignCells(blank);
+    if(words.empty()) return;
+
+    // Greedy start: any warm-start placements, then the full search's first
+    // descent over the other words, one node per word
+    SolveShared start;
+    ctx.shared = &start;
+    applyFixedPlacements(ctx, grid, shared.fixed, required_flags);
+    ctx.nodes = 0;
+    ctx.node_limit = ctx.word_order.size() + 1;
+    ctx.search(ctx, 0, grid, ctx.base_overlap);
+    vector<WordPlacement> current = repair.placements, best = current;
+    int64_t current_score = start.best_score.load(), best_score = current_score;
+    raiseSharedBest(shared, best_score, worker_id);
+    auto reportBest = [&]() {
+        if(!shared.report_progress) return;
+        layPlacements(ctx, blank, laid, best, required_flags);
+        result.grid.assignCells(laid);
+        result.placements = best;
+        result.num_required_placed = scoreRequired(best_score);
+        result.num_placed = scorePlaced(best_score);
+        result.total_overlap_score = scoreOverlap(best_score);
+        publishProgress(shared, result);
+    };
+    reportBest();
+
+    auto started = chrono::steady_clock::now();
+    long long budget = workerNodeBudget(config), spent = ctx.nodes;
+    vector<WordPlacement> kept;
+    vector<int> free_words;
+    vector<bool> placed(words.size());
+    while(!shared.stop.load(memory_order_relaxed) && (!budget || spent < budget)) {
+        // Destroy
+        kept.clear();
+        free_words.clear();
+        if(!current.empty() && rng() % 2) {
+            int h = 1 + rng() % max(1, rows / 3), w = 1 + rng() % max(1, cols / 3);
+            int r0 = rng() % max(1, rows - h + 1), c0 = rng() % max(1, cols - w + 1);
+            vector<WordPlacement> hit;
+            for(auto &p : current) {
+                bool inside = false;
+                for(int i = 0; i < (int)words[p.word_index].size() && !inside; i++) {
+                    int r = p.row + i * p.delta_row, c = p.col + i * p.delta_col;
+                    inside = r >= r0 && r < r0 + h && c >= c0 && c < c0 + w;
+                }
+                (inside ? hit : kept).push_back(p);
+            }
+            shuffle(hit.begin(), hit.end(), rng);
+            for(size_t i = 0; i < hit.size(); i++) {
+                if((int)i < LNS_MAX_REMOVED) free_words.push_back(hit[i].word_index);
+                else kept.push_back(hit[i]);
+            }
+        } else if(!current.empty()) {
+            kept = current;
+            shuffle(kept.begin(), kept.end(), rng);
+            int removed = 1 + rng() % min<int>(LNS_MAX_REMOVED, kept.size());
+            for(int i = 0; i < removed; i++) {
+                free_words.push_back(kept.back().word_index);
+                kept.pop_back();
+            }
+        }
+
+        // Free words: the removed ones plus a sample of the unplaced ones
+        fill(placed.begin(), placed.end(), false);
+        for(auto &p : current) placed[p.word_index] = true;
+        vector<int> unplaced;
+        for(int i = 0; i < (int)words.size(); i++)
+            if(!placed[i]) {
+                if(required_flags[i]) free_words.push_back(i);
+                else unplaced.push_back(i);
+            }
+        shuffle(unplaced.begin(), unplaced.end(), rng);
+        for(int i = 0; i < (int)unplaced.size() && i < LNS_EXTRA_WORDS; i++) free_words.push_back(unplaced[i]);
+        if(free_words.empty()) continue;   // the window missed every placement
+
+        // Repair
+        int64_t kept_score = layPlacements(ctx, blank, grid, kept, required_flags);
+        int64_t score = repairPlacements(ctx, grid, kept, kept_score, free_words, required_flags, rng);
+        spent += ctx.nodes;
+
+        // Accept
+        double progress = budget ? (double)spent / budget
+                                 : chrono::duration<double, milli>(chrono::steady_clock::now() - started).count() /
+                                   max(1, config.runtime_ms);
+        double temperature = LNS_START_TEMPERATURE * max(0.0, 1.0 - progress);
+        double delta = lnsEnergy(score) - lnsEnergy(current_score);
+        if(delta >= 0 || (temperature > 0 && uniform_real_distribution<double>(0, 1)(rng) < exp(delta / temperature))) {
+            current = repair.placements;
+            current_score = score;
+        }
+        if(score > best_score) {
+            best = repair.placements;
+            best_score = score;
+            raiseSharedBest(shared, score, worker_id);
+            reportBest();
+        }
+    }
+
+    layPlacements(ctx, blank, laid, best, required_flags);
+    result.grid.assignCells(laid);
+    result.placements = best;
+    result.num_required_placed = scoreRequired(best_score);
+    result.num_placed = scorePlaced(best_score);
+    result.total_overlap_score = scoreOverlap(best_score);
+    result.stats = ctx.stats;
+}
+
+/*---------------------------------------------------------------
+  WARM START
+---------------------------------------------------------------*/
+
+// The previous placements that are still valid here, in order: on the
+// board, one per word, and agreeing with every placement kept before them
+vector<WordPlacement> compatiblePlacements(const vector<string>& words, const vector<WordPlacement>& previous,
+                                           int rows, int cols) {
+    vector<WordPlacement> kept;
+    Grid grid(rows, cols);
+    vector<bool> used(words.size(), false);
+    for(auto &p : previous) {
+        if(p.word_index < 0 || p.word_index >= (int)words.size() || used[p.word_index]) continue;
+        if(find(DIRECTIONS.begin(), DIRECTIONS.end(), make_pair(p.delta_row, p.delta_col)) == DIRECTIONS.end())
+            continue;
+        const string &word = words[p.word_index];
+        int length = word.size(), end_row = p.row + (length - 1) * p.delta_row,
+            end_col = p.col + (length - 1) * p.delta_col;
+        if(length == 0 || p.row < 0 || p.row >= rows || p.col < 0 || p.col >= cols || end_row < 0 ||
+           end_row >= rows || end_col < 0 || end_col >= cols)
+            continue;
+        int pos = grid.index(p.row, p.col), step = grid.step(p.delta_row, p.delta_col), overlap_val;
+        if(!canPlaceWord(grid, word, pos, step, overlap_val)) continue;
+        placeWord(grid, word, pos, step);
+        used[p.word_index] = true;
+        kept.push_back(p);
+    }
+    return kept;
+}
+
+// A result holding just the given (compatible) placements
+PuzzleResult layoutResult(const vector<string>& words, const vector<bool>& required_flags,
+                          const vector<WordPlacement>& placements, int rows, int cols) {
+    PuzzleResult result;
+    result.grid = Grid(rows, cols);
+    for(auto &p : placements) {
+        const string &word = words[p.word_index];
+        int pos = result.grid.index(p.row, p.col), step = result.grid.step(p.delta_row, p.delta_col), overlap_val;
+        canPlaceWord(result.grid, word, pos, step, overlap_val);
+        placeWord(result.grid, word, pos, step);
+        result.total_overlap_score += overlap_val;
+        result.num_required_placed += required_flags[p.word_index];
+    }
+    result.num_placed = placements.size();
+    result.placements = placements;
+    return result;
+}
+
+} // namespace
+
+vector<WordPlacement> carryOverPlacements(const vector<string>& old_words, const vector<WordPlacement>& old_placements,
+                                          const vector<string>& new_words) {
+    map<string, deque<int>> new_index;
+    for(int i = 0; i < (int)new_words.size(); i++) new_index[new_words[i]].push_back(i);
+    vector<WordPlacement> carried;
+    for(auto &p : old_placements) {
+        if(p.word_index < 0 || p.word_index >= (int)old_words.size()) continue;
+        auto it = new_index.find(old_words[p.word_index]);
+        if(it == new_index.end() || it->second.empty()) continue;
+        carried.push_back({it->second.front(), p.row, p.col, p.delta_row, p.delta_col});
+        it->second.pop_front();
+    }
+    return carried;
+}
+
+/*---------------------------------------------------------------
+  SOLVER ENTRY POINTS
+---------------------------------------------------------------*/
+PuzzleResult Solver::solve(const vector<string>& words, const vector<bool>& required_flags) {
+    return solve(words, required_flags, {});
+}
+
+PuzzleResult Solver::solve(const vector<string>& words, const vector<bool>& required_flags,
+                           const vector<WordPlacement>& previous) {
+    const SolverConfig config = this->config;
+    int rows = config.rows, cols = config.cols;
+
+    // Every thread prunes against the shared best score and stops on the shared flag
+    int thread_count = max(1, config.threads);
+    SolveShared shared;
+    shared.log_improvements = WORDSEARCH_STATS;
+    if(config.transposition_bits > 0)
+        shared.table = make_unique<TranspositionTable>(min(config.transposition_bits, 30));
+    if(config.stop_at_required)
+        shared.goal_score = packScore(count(required_flags.begin(), required_flags.end(), true), 0, 0);
+    shared.report_progress = (bool)config.progress;
+
+    // Warm start: what still fits becomes every worker's fixed base, or an
+    // incumbent that a full search has to beat
+    vector<WordPlacement> kept = compatiblePlacements(words, previous, rows, cols);
+    PuzzleResult incumbent;
+    bool has_incumbent = false;
+    if(config.warm_start == WARM_START_FIXED || config.engine == ENGINE_LNS) {
+        shared.fixed = move(kept);
+    } else if(!kept.empty()) {
+        incumbent = layoutResult(words, required_flags, kept, rows, cols);
+        has_incumbent = true;
+        raiseSharedBest(shared, resultScore(incumbent));
+        if(shared.report_progress) publishProgress(shared, incumbent);
+    }
+    {
+        lock_guard<mutex> guard(active_lock);
+        active_stop = &shared.stop;
+        if(cancel_pending) shared.stop = true;
+        cancel_hit = cancel_pending;
+        cancel_pending = false;
+    }
+    unique_ptr<ProgressReporter> reporter;
+    if(shared.report_progress) reporter = make_unique<ProgressReporter>(shared, config, words);
+    vector<PuzzleResult> worker_results(thread_count);
+    vector<thread> workers;
+    // A node budget replaces the time limit, so budgeted runs repeat exactly
+    SolveTimer timer(shared.stop, config.node_budget > 0 ? INT_MAX : config.runtime_ms);
+    if(config.engine == ENGINE_LNS) {
+        // Independent local searches, each with its own random moves
+        for(int t = 1; t < thread_count; t++)
+            workers.emplace_back(runLnsWorker, t, cref(words), cref(required_flags), cref(config),
+                                 ref(shared), ref(worker_results[t]));
+        runLnsWorker(0, words, required_flags, config, shared, worker_results[0]);
+        for(auto &w : workers) w.join();
+    } else if(config.parallel == PARALLEL_SUBTREE && thread_count > 1) {
+        // Work-stealing split of one search, seeded with the root subtree
+        SubtreeScheduler scheduler(thread_count, config.split_depth);
+        scheduler.push(0, SubtreeTask());
+        for(int t = 1; t < thread_count; t++)
+            workers.emplace_back(runSubtreeWorker, t, cref(words), cref(required_flags), cref(config),
+                                 ref(shared), ref(scheduler), ref(worker_results[t]));
+        runSubtreeWorker(0, words, required_flags, config, shared, scheduler, worker_results[0]);
+        for(auto &w : workers) w.join();
+    } else {
+        for(int t = 1; t < thread_count; t++)
+            workers.emplace_back(runSolverWorker, t, cref(words), cref(required_flags), cref(config),
+                                 ref(shared), ref(worker_results[t]));
+        runSolverWorker(0, words, required_flags, config, shared, worker_results[0]);
+        for(auto &w : workers) w.join();
+    }
+    reporter.reset();
+    bool cancelled;
+    {
+        lock_guard<mutex> guard(active_lock);
+        active_stop = nullptr;
+        cancelled = cancel_hit;
+    }
+    bool timed_out = timer.expired();
+
+    // Keep the best result, preferring lower worker ids on ties
+    int best_worker = 0;
+    for(int t = 1; t < thread_count; t++)
+        if(packScore(worker_results[t].num_required_placed, worker_results[t].num_placed,
+                     worker_results[t].total_overlap_score) >
+           packScore(worker_results[best_worker].num_required_placed, worker_results[best_worker].num_placed,
+                     worker_results[best_worker].total_overlap_score))
+            best_worker = t;
+    PuzzleResult best_result = move(worker_results[best_worker]);
+
+    // Telemetry covers every worker, not just the winner
+    SolverStats &stats = best_result.stats;
+    for(int t = 0; t < thread_count; t++) {
+        if(t == best_worker) continue;
+        const SolverStats &other = worker_results[t].stats;
+        stats.nodes += other.nodes;
+        stats.candidates_generated += other.candidates_generated;
+        stats.candidates_explored += other.candidates_explored;
+        stats.prunes_count += other.prunes_count;
+        stats.prunes_required += other.prunes_required;
+        stats.prunes_overlap += other.prunes_overlap;
+        stats.prunes_transposition += other.prunes_transposition;
+        stats.peak_depth = max(stats.peak_depth, other.peak_depth);
+    }
+    stats.timeouts = timed_out;
+    stats.improvements = move(shared.improvements);
+
+    // Workers only record layouts that beat the incumbent
+    if(has_incumbent && resultScore(best_result) <= resultScore(incumbent)) {
+        incumbent.stats = move(stats);
+        best_result = move(incumbent);
+    }
+    best_result.cancelled = cancelled;
+
+    // Identify which words were placed
+    vector<bool> placed(words.size(), false);
+    for(auto &p : best_result.placements) placed[p.word_index] = true;
+    for(size_t i = 0; i < words.size(); i++)
+        (placed[i] ? best_result.placed_words : best_result.unplaced_words).push_back(words[i]);
+
+    // Fill remaining cells randomly
+    mt19937_64 rng(config.seed ? config.seed : (uint64_t)chrono::steady_clock::now().time_since_epoch().count());
+    uniform_int_distribution<int> dist(0, 25);
+    for(int r = 0; r < rows; r++)
+        for(int c = 0; c < cols; c++)
+            if(best_result.grid.at(r, c) == '.')
+                best_result.grid.at(r, c) = char('A' + dist(rng));
+
+    return best_result;
+}
+
+void Solver::cancel() {
+    lock_guard<mutex> guard(active_lock);
+    if(active_stop) {
+        active_stop->store(true, memory_order_relaxed);
+        cancel_hit = true;
+    } else {
+        cancel_pending = true;
+    }
+}
+
+/*---------------------------------------------------------------
+  SMALLEST GRID SEARCH
+---------------------------------------------------------------*/
+namespace {
+
+// Probes per round, and the share of the runtime one round may take
+const int SIZE_MIN_PROBES = 2;
+const int SIZE_PROBE_SHARE = 4;
+
+} // namespace
+
+PuzzleResult solveSmallestGrid(const SolverConfig &config, const vector<string>& words,
+                               const vector<bool>& required_flags, double aspect) {
+    auto start = chrono::steady_clock::now();
+    auto elapsedMs = [&]() {
+        return (int)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    };
+    auto colsFor = [&](int rows) { return max(1, (int)lround(rows * aspect)); };
+
+    // A size succeeds when every goal word is placed
+    vector<bool> goal_flags = required_flags;
+    if(find(goal_flags.begin(), goal_flags.end(), true) == goal_flags.end()) goal_flags.assign(words.size(), true);
+    int goal_count = 0, longest = 1, goal_letters = 0;
+    for(size_t i = 0; i < words.size(); i++)
+        if(goal_flags[i]) {
+            goal_count++;
+            longest = max(longest, (int)words[i].size());
+            goal_letters += words[i].size();
+        }
+
+    // Sizes up to failed are known (or assumed, after a timeout) to fail;
+    // fits is the smallest size seen to succeed, or 0. The first upper guess
+    // is the usual estimate for the goal words alone
+    int failed = 0;
+    while(max(failed, colsFor(failed)) < longest) failed++;
+    failed--;
+    const int estimate = max(failed + 1, (int)ceil(sqrt((double)goal_letters)) + 2);
+    int upper = estimate, fits = 0;
+    PuzzleResult fit_result;
+    int probe_count = max(SIZE_MIN_PROBES, config.threads);
+    int probe_ms = max(1, config.runtime_ms / SIZE_PROBE_SHARE);
+    while(elapsedMs() < config.runtime_ms && (fits == 0 || fits - failed > 1)) {
+        // Spread this round's probes over (failed, upper]; upper itself is
+        // always among them
+        int top = fits ? fits - 1 : upper;
+        vector<int> sizes;
+        for(int k = 1; k <= probe_count; k++) {
+            int size = failed + (int)ceil((double)k * (top - failed) / probe_count);
+            if(size > failed && (sizes.empty() || size > sizes.back())) sizes.push_back(size);
+        }
+
+        SolverConfig probe_config = config;
+        probe_config.runtime_ms = max(1, min(probe_ms, config.runtime_ms - elapsedMs()));
+        probe_config.threads = max(1, config.threads / (int)sizes.size());
+        probe_config.stop_at_required = true;
+        probe_config.node_budget = 0;   // probes are always timed slices
+        probe_config.progress = nullptr;  // only the final solve reports progress
+        vector<unique_ptr<Solver>> probes;
+        for(size_t i = 0; i < sizes.size(); i++) {
+            probes.push_back(make_unique<Solver>(probe_config));
+            probes[i]->config.rows = sizes[i];
+            probes[i]->config.cols = colsFor(sizes[i]);
+        }
+        vector<PuzzleResult> results(sizes.size());
+        mutex round_lock;
+        vector<thread> threads;
+        for(size_t i = 0; i < sizes.size(); i++)
+            threads.emplace_back([&, i]() {
+                results[i] = probes[i]->solve(words, goal_flags);
+                if(results[i].num_required_placed < goal_count) return;
+                // No larger size can win any more
+                lock_guard<mutex> guard(round_lock);
+                for(size_t j = i + 1; j < sizes.size(); j++) probes[j]->cancel();
+            });
+        for(auto &t : threads) t.join();
+
+        // The first success bounds the answer; failures below it raise the floor
+        bool found = false;
+        for(size_t i = 0; i < sizes.size() && !found; i++) {
+            if(results[i].num_required_placed == goal_count) {
+                found = true;
+                fits = sizes[i];
+                fit_result = move(results[i]);
+                fit_result.num_required_placed = 0;
+                for(auto &p : fit_result.placements) fit_result.num_required_placed += required_flags[p.word_index];
+            } else {
+                failed = sizes[i];
+            }
+        }
+        if(!found) upper = failed + max(1, (failed + 1) / 2);
+    }
+
+    // Solve the winning size properly with the time left; the probe stopped
+    // at its first success, so keep whichever is better. Without any success
+    // (probes that only timed out prove little) the estimate gets one slice
+    SolverConfig final_config = config;
+    final_config.runtime_ms = config.runtime_ms - elapsedMs();
+    if(fits == 0) {
+        fits = estimate;
+        final_config.runtime_ms = max(final_config.runtime_ms, probe_ms);
+    }
+    final_config.rows = fits;
+    final_config.cols = colsFor(fits);
+    if(final_config.runtime_ms <= 0) return fit_result;
+    PuzzleResult polished = Solver(final_config).solve(words, required_flags);
+    if(fit_result.grid.rows == fits && resultScore(fit_result) > resultScore(polished)) return fit_result;
+    return polished;
+}
+
+} // namespace wordsearch
@@ -0,0 +1,365 @@
+/*
+=====================================================================
+LIBWORDSEARCH
+---------------------------------------------------------------------
+Re-entrant word search solver library. Configure a Solver, then call
+solve() with the normalized word list; every solve owns its state, so
+separate Solver objects can run concurrently in one process.
+=====================================================================
+*/
+
+#ifndef LIBWORDSEARCH_H
+#define LIBWORDSEARCH_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+// Search telemetry (PuzzleResult::stats) is collected unless the library
+// is built with -DWORDSEARCH_STATS=0, which compiles the counters out
+#ifndef WORDSEARCH_STATS
+#define WORDSEARCH_STATS 1
+#endif
+
+namespace wordsearch {
+
+/*---------------------------------------------------------------
+  CONSTANTS
+---------------------------------------------------------------*/
+
+// All 8 directions (horizontal, vertical, diagonal)
+inline const std::vector<std::pair<int,int>> DIRECTIONS = {
+    {0,1}, {0,-1}, {1,0}, {-1,0}, {1,1}, {1,-1}, {-1,1}, {-1,-1}
+};
+
+// Search engines: in-place place/undo on one grid (default), grid copy per
+// candidate, in-place with bitboard placement checks, or large neighbourhood
+// local search (anytime, for word lists too big to search exhaustively)
+enum SolverEngine { ENGINE_INPLACE, ENGINE_COPY, ENGINE_BITBOARD, ENGINE_LNS };
+
+// How search threads split the work: independent portfolio members or
+// work-stealing subtrees of one search
+enum ParallelMode { PARALLEL_PORTFOLIO, PARALLEL_SUBTREE };
+
+// What a warm start does with the previous placements that still fit: keep
+// them fixed and search only the other words, or only make them the
+// incumbent a full search must beat. The LNS engine always starts from
+// them and may move them either way
+enum WarmStartMode { WARM_START_FIXED, WARM_START_INCUMBENT };
+
+// Which word the search branches on next. Required words always come
+// first; within each group: longest first (default); longest first, with
+// extra weight on letters no other word shares, since those words can
+// hardly overlap anything placed later; or, recounted at every node, the
+// word with the fewest placements left on the board. ORDER_MIXED gives
+// portfolio threads the three in turn (thread 0 keeps ORDER_LENGTH)
+enum WordOrdering { ORDER_LENGTH, ORDER_ISOLATED, ORDER_DYNAMIC, ORDER_MIXED };
+
+/*---------------------------------------------------------------
+  DATA STRUCTURES
+---------------------------------------------------------------*/
+// word_index refers to the word list passed to Solver::solve
+struct WordPlacement {
+    int word_index;
+    int row, col;
+    int delta_row, delta_col;
+};
+
+// Flat row-major grid surrounded by a one-cell sentinel border, so a word
+// stepping off the board hits GRID_BORDER instead of needing bounds checks
+const char GRID_BORDER = '#';
+
+// Extra bytes after every buffer so vector kernels may over-read a full register
+const int GRID_SIMD_SLACK = 32;
+
+// Memory layouts in which a direction's cells are contiguous: the row-major
+// grid itself plus column-, diagonal- and anti-diagonal-major shadow copies
+enum GridLane { LANE_ROW, LANE_COL, LANE_DIAG, LANE_ANTI };
+
+// Largest board side the bitboard lanes can hold (one uint64_t per lane)
+const int GRID_BITBOARD_MAX = 64;
+
+// One direction of each of the 4 line orientations (see Grid::free_runs)
+inline const int FREE_RUN_DIRECTIONS[4] = {0, 2, 4, 5};
+
+struct Grid {
+    int rows = 0, cols = 0, stride = 0;
+    std::vector<char> cells;
+
+    // Shadow copies indexed by LANE_COL..LANE_ANTI (empty unless requested);
+    // they are only kept in sync through set()
+    int lane_stride = 0;
+    std::vector<char> shadows[3];
+
+    // Flat offsets of the cells holding each letter, maintained by set()
+    std::vector<int> letter_cells[26];
+
+    // Bitboards per GridLane (empty unless requested): bit i of
+    // occupied_bits[lane][l] is set when cell i along lane l is filled, and
+    // of letter_bits[lane][letter * laneCount(lane) + l] when it holds letter
+    std::vector<uint64_t> occupied_bits[4], letter_bits[4];
+
+    // Empty-run lengths (empty unless requested): after syncFreeRuns(),
+    // free_runs[pos * 4 + l] is how many empty cells start at pos along
+    // FREE_RUN_DIRECTIONS[l], so a word fits there over empty cells only
+    // when it is no longer (the opposite direction reads the run from the
+    // word's far end). set() only notes the cells it fills or empties, and
+    // free_run_empty holds each cell's state as of the last sync
+    std::vector<uint16_t> free_runs;
+    std::vector<char> free_run_empty;
+    std::vector<int> free_run_changes;
+
+    Grid() {}
+    Grid(int r, int c, bool with_shadows = false, bool with_bitboards = false, bool with_free_runs = false)
+        : rows(r), cols(c), stride(c + 2), cells((r + 2) * (c + 2) + GRID_SIMD_SLACK, GRID_BORDER) {
+        for(int rr = 0; rr < rows; rr++)
+            std::fill_n(cells.begin() + index(rr, 0), cols, '.');
+        if(with_shadows) {
+            lane_stride = rows + 2;
+            int lane_counts[3] = { cols + 2, rows + cols + 1, rows + cols + 1 };
+            for(int s = 0; s < 3; s++)
+                shadows[s].assign(lane_counts[s] * lane_stride + GRID_SIMD_SLACK, GRID_BORDER);
+            for(int rr = 0; rr < rows; rr++)
+                for(int cc = 0; cc < cols; cc++)
+                    for(int s = 0; s < 3; s++)
+                        shadows[s][laneIndex(GridLane(s + 1), rr, cc)] = '.';
+        }
+        if(with_bitboards && rows <= GRID_BITBOARD_MAX && cols <= GRID_BITBOARD_MAX)
+            for(int lane = 0; lane < 4; lane++) {
+                occupied_bits[lane].assign(laneCount(GridLane(lane)), 0);
+                letter_bits[lane].assign(26 * laneCount(GridLane(lane)), 0);
+            }
+        if(with_free_runs) rebuildFreeRuns();
+    }
+
+    int index(int r, int c) const { return (r + 1) * stride + (c + 1); }
+    int step(int dr, int dc) const { return dr * stride + dc; }
+    char &at(int r, int c) { return cells[index(r, c)]; }
+    char at(int r, int c) const { return cells[index(r, c)]; }
+    std::string rowString(int r) const {
+        return std::string(cells.begin() + index(r, 0), cells.begin() + index(r, 0) + cols);
+    }
+
+    // Offset of (r, c) inside a shadow lane; moving along the lane is +1
+    int laneIndex(GridLane lane, int r, int c) const {
+        int lane_id = lane == LANE_COL ? c : lane == LANE_DIAG ? c - r + rows - 1 : r + c;
+        return (lane_id + 1) * lane_stride + (r + 1);
+    }
+
+    // Pointer to (r, c) in the layout where the lane's direction is contiguous
+    const char *lanePointer(GridLane lane, int r, int c) const {
+        if(lane == LANE_ROW) return cells.data() + index(r, c);
+        return shadows[lane - 1].data() + laneIndex(lane, r, c);
+    }
+
+    int laneCount(GridLane lane) const {
+        return lane == LANE_ROW ? rows : lane == LANE_COL ? cols : rows + cols - 1;
+    }
+
+    // Bitboard lane holding (r, c) and the cell's bit along it; lanes run in
+    // the same order as the shadow copies
+    int bitLane(GridLane lane, int r, int c) const {
+        return lane == LANE_ROW ? r : lane == LANE_COL ? c : lane == LANE_DIAG ? c - r + rows - 1 : r + c;
+    }
+    int bitOffset(GridLane lane, int r, int c) const { return lane == LANE_ROW ? c : r; }
+
+    // Take other's size and cells only, leaving out its letter index and the
+    // search-only shadow lanes, bitboards and empty runs (results keep just this)
+    void assignCells(const Grid &other) {
+        rows = other.rows;
+        cols = other.cols;
+        stride = other.stride;
+        cells = other.cells;
+    }
+
+    bool hasBitboards() const { return !occupied_bits[0].empty(); }
+    bool hasFreeRuns() const { return !free_runs.empty(); }
+    int freeRunStep(int l) const {
+        return step(DIRECTIONS[FREE_RUN_DIRECTIONS[l]].first, DIRECTIONS[FREE_RUN_DIRECTIONS[l]].second);
+    }
+
+    // Recompute every empty run from the cells
+    void rebuildFreeRuns() {
+        free_runs.assign(cells.size() * 4, 0);
+        free_run_empty.resize(cells.size());
+        for(size_t pos = 0; pos < cells.size(); pos++) free_run_empty[pos] = cells[pos] == '.';
+        free_run_changes.clear();
+        for(int l = 0; l < 4; l++) {
+            int step = freeRunStep(l);
+            for(int rr = 0; rr < rows; rr++)
+                for(int cc = 0; cc < cols; cc++) {
+                    int pos = index(rr, cc), run = 0;
+                    if(cells[pos] != '.' || cells[pos - step] == '.') continue;
+                    while(cells[pos + run * step] == '.') run++;
+                    for(int k = 0; k < run; k++) free_runs[(pos + k * step) * 4 + l] = run - k;
+                }
+        }
+    }
+
+    // Bring the empty runs up to date. Only cells whose state differs from
+    // the last sync count, so a word placed and undone since costs nothing;
+    // each of those rewrites itself and the empty cells just behind it
+    // along its 4 lines, which leaves every run right whatever their order
+    void syncFreeRuns() {
+        for(int pos : free_run_changes) {
+            bool empty = cells[pos] == '.';
+            if(empty == (bool)free_run_empty[pos]) continue;
+            free_run_empty[pos] = empty;
+            for(int l = 0; l < 4; l++) {
+                int step = freeRunStep(l);
+                int run = empty ? free_runs[(pos + step) * 4 + l] + 1 : 0;
+                free_runs[pos * 4 + l] = run;
+                for(int q = pos - step; cells[q] == '.'; q -= step) free_runs[q * 4 + l] = ++run;
+            }
+        }
+        free_run_changes.clear();
+    }
+
+    // Write one cell, updating the letter index and mirroring it into the
+    // shadow lanes and bitboards when present
+    void set(int pos, char ch) {
+        char old = cells[pos];
+        if(old == ch) return;
+        cells[pos] = ch;
+        if(old != '.') {
+            // Undo clears cells in reverse fill order, so this is normally the back
+            std::vector<int> &list = letter_cells[old - 'A'];
+            list.erase(std::find(list.rbegin(), list.rend(), pos).base() - 1);
+        }
+        if(ch != '.') letter_cells[ch - 'A'].push_back(pos);
+        int r = pos / stride - 1, c = pos % stride - 1;
+        if(!shadows[0].empty())
+            for(int s = 0; s < 3; s++)
+                shadows[s][laneIndex(GridLane(s + 1), r, c)] = ch;
+        if(hasBitboards())
+            for(int lane = 0; lane < 4; lane++) {
+                int l = bitLane(GridLane(lane), r, c), count = laneCount(GridLane(lane));
+                uint64_t bit = 1ULL << bitOffset(GridLane(lane), r, c);
+                if(old != '.') letter_bits[lane][(old - 'A') * count + l] &= ~bit;
+                if(ch != '.') letter_bits[lane][(ch - 'A') * count + l] |= bit;
+                if(ch != '.') occupied_bits[lane][l] |= bit;
+                else occupied_bits[lane][l] &= ~bit;
+            }
+        if(hasFreeRuns() && (old == '.') != (ch == '.')) {
+            free_run_changes.push_back(pos);
+            if(free_run_changes.size() > cells.size()) syncFreeRuns();
+        }
+    }
+};
+
+// One raise of the best score during a solve, microseconds after it started
+struct SolveImprovement {
+    long long elapsed_us;
+    int worker;
+    int required, placed, overlap;
+};
+
+// Search telemetry, summed over all threads of a solve (the counters and
+// the log stay empty when built without WORDSEARCH_STATS)
+struct SolverStats {
+    long long nodes = 0;
+    long long candidates_generated = 0;    // placements found to fit
+    long long candidates_explored = 0;     // ... and actually recursed into
+    long long prunes_count = 0;            // even placing every remaining word could not beat the best
+    long long prunes_required = 0;         // ... once required words that no longer fit are left out
+    long long prunes_overlap = 0;          // tied counts, but the overlap bound cannot beat the best
+    long long prunes_transposition = 0;    // state already reached with at least this score
+    int peak_depth = 0;                    // deepest word index reached
+    int timeouts = 0;                      // 1 when the runtime ran out before the search finished
+    std::vector<SolveImprovement> improvements;
+};
+
+struct PuzzleResult {
+    Grid grid;
+    std::vector<WordPlacement> placements;
+    std::vector<std::string> placed_words;
+    std::vector<std::string> unplaced_words;
+    int num_required_placed = 0;
+    int num_placed = 0;
+    int total_overlap_score = 0;
+    bool cancelled = false;   // Solver::cancel() stopped the solve early
+    SolverStats stats;
+};
+
+// Per-solver settings; rows and cols must be set before solving
+struct SolverConfig {
+    int rows = 0, cols = 0;
+    int runtime_ms = 2000;
+    SolverEngine engine = ENGINE_INPLACE;
+    bool use_simd = true;          // vectorized canPlaceWord when the CPU supports it
+    int threads = 1;
+    ParallelMode parallel = PARALLEL_PORTFOLIO;
+    int split_depth = 4;           // subtree mode only splits nodes shallower than this
+    int transposition_bits = 16;   // log2 slots of the shared transposition table; 0 disables it
+    bool stop_at_required = false; // finish as soon as every required word is placed (size probes)
+    long long node_budget = 0;     // search nodes shared by all threads, instead of runtime_ms (0: time limit)
+    uint64_t seed = 0;             // random fill seed; 0 draws one from the clock
+    WarmStartMode warm_start = WARM_START_FIXED;
+    WordOrdering ordering = ORDER_LENGTH;
+    // Called during the solve with each newer best layout (cells still '.'
+    // where no word passes), at most once per progress_interval_ms and never
+    // after solve() returns; it runs on a helper thread, one call at a time
+    std::function<void(const PuzzleResult &)> progress;
+    int progress_interval_ms = 100;
+};
+
+/*---------------------------------------------------------------
+  SOLVER API
+---------------------------------------------------------------*/
+
+// Convert string to uppercase alphabetic only
+std::string normalizeWord(const std::string &input);
+
+class Solver {
+public:
+    SolverConfig config;
+
+    Solver() {}
+    explicit Solver(const SolverConfig &cfg) : config(cfg) {}
+
+    // Place as many of the (normalized) words as possible, then fill the
+    // remaining cells randomly. Results rank by required words placed, then
+    // words placed, then overlap
+    PuzzleResult solve(const std::vector<std::string>& words, const std::vector<bool>& required_flags);
+
+    // Warm start from a previous layout: previous holds placements indexed
+    // into this words list (see carryOverPlacements). Those still on the
+    // board and consistent with each other are kept per config.warm_start;
+    // the rest are dropped and their words searched again
+    PuzzleResult solve(const std::vector<std::string>& words, const std::vector<bool>& required_flags,
+                       const std::vector<WordPlacement>& previous);
+
+    // Stop the solve running on another thread; it returns its best so far.
+    // A cancel that arrives before solve() starts stops the next solve
+    void cancel();
+
+private:
+    std::mutex active_lock;
+    std::atomic<bool> *active_stop = nullptr;
+    bool cancel_pending = false;
+    bool cancel_hit = false;   // cancel() reached the running solve
+};
+
+// Map a previous result's placements (indexed into old_words) onto a new
+// word list by word text, so words kept across an edit keep their spot.
+// Placements of removed words are dropped; repeated words pair up in order
+std::vector<WordPlacement> carryOverPlacements(const std::vector<std::string>& old_words,
+                                               const std::vector<WordPlacement>& old_placements,
+                                               const std::vector<std::string>& new_words);
+
+// Smallest grid, with cols = round(rows * aspect), on which every required
+// word (every word, when none is marked) gets placed. Candidate sizes are
+// probed concurrently in slices of config.runtime_ms, larger probes are
+// cancelled once a smaller one succeeds, and the winning size is re-solved
+// with the time left. config.rows and config.cols are ignored
+PuzzleResult solveSmallestGrid(const SolverConfig &config, const std::vector<std::string>& words,
+                               const std::vector<bool>& required_flags, double aspect = 1.0);
+
+} // namespace wordsearch
+
+#endif
@@ -0,0 +1,229 @@
+/*
+=====================================================================
+MINIMAL JSON READER
+---------------------------------------------------------------------
+Just enough JSON to read server/batch requests: objects, arrays,
+strings (with escapes), numbers, booleans and null. Malformed input,
+including numbers outside the JSON grammar and nesting deeper than
+JSON_MAX_DEPTH, throws std::runtime_error.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_MINIJSON_H
+#define WORDSEARCH_MINIJSON_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <cstdlib>
+#include <cctype>
+
+// Deepest nesting of arrays and objects accepted, so hostile input cannot
+// exhaust the stack of a long-running server
+const int JSON_MAX_DEPTH = 64;
+
+struct JsonValue {
+    enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+    Type type = JSON_NULL;
+    bool boolean = false;
+    double number = 0;
+    std::string text;         // string value, or the raw number literal
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    // Member lookup on objects; nullptr when absent or not an object
+    const JsonValue *find(const std::string &key) const {
+        if(type != JSON_OBJECT) return nullptr;
+        for(auto &m : members)
+            if(m.first == key) return &m.second;
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string &input) : s(input) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue();
+        skipSpace();
+        if(pos != s.size()) fail("trailing characters");
+        return value;
+    }
+
+private:
+    const std::string &s;
+    size_t pos = 0;
+    int depth = 0;
+
+    [[noreturn]] void fail(const char *what) {
+        throw std::runtime_error(std::string("invalid JSON: ") + what + " at offset " + std::to_string(pos));
+    }
+
+    void skipSpace() {
+        while(pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) pos++;
+    }
+
+    bool consume(const char *literal) {
+        size_t n = 0;
+        while(literal[n]) n++;
+        if(s.compare(pos, n, literal) != 0) return false;
+        pos += n;
+        return true;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if(pos >= s.size()) fail("unexpected end");
+        JsonValue value;
+        char ch = s[pos];
+        if(ch == '{' || ch == '[') {
+            if(++depth > JSON_MAX_DEPTH) fail("nesting too deep");
+            JsonValue nested = ch == '{' ? parseObject() : parseArray();
+            depth--;
+            return nested;
+        }
+        if(ch == '"') {
+            value.type = JsonValue::JSON_STRING;
+            value.text = parseString();
+            return value;
+        }
+        if(consume("true")) { value.type = JsonValue::JSON_BOOL; value.boolean = true; return value; }
+        if(consume("false")) { value.type = JsonValue::JSON_BOOL; return value; }
+        if(consume("null")) return value;
+        if(ch != '-' && !isdigit((unsigned char)ch)) fail("unexpected character");
+        value.type = JsonValue::JSON_NUMBER;
+        value.text = parseNumber();
+        value.number = strtod(value.text.c_str(), nullptr);
+        return value;
+    }
+
+    JsonValue parseObject() {
+        JsonValue value;
+        value.type = JsonValue::JSON_OBJECT;
+        pos++;
+        skipSpace();
+        if(pos < s.size() && s[pos] == '}') { pos++; return value; }
+        for(;;) {
+            skipSpace();
+            if(pos >= s.size() || s[pos] != '"') fail("expected member name");
+            std::string key = parseString();
+            skipSpace();
+            if(pos >= s.size() || s[pos] != ':') fail("expected ':'");
+            pos++;
+            value.members.push_back({key, parseValue()});
+            skipSpace();
+            if(pos < s.size() && s[pos] == ',') { pos++; continue; }
+            if(pos < s.size() && s[pos] == '}') { pos++; return value; }
+            fail("expected ',' or '}'");
+        }
+    }
+
+    JsonValue parseArray() {
+        JsonValue value;
+        value.type = JsonValue::JSON_ARRAY;
+        pos++;
+        skipSpace();
+        if(pos < s.size() && s[pos] == ']') { pos++; return value; }
+        for(;;) {
+            value.items.push_back(parseValue());
+            skipSpace();
+            if(pos < s.size() && s[pos] == ',') { pos++; continue; }
+            if(pos < s.size() && s[pos] == ']') { pos++; return value; }
+            fail("expected ',' or ']'");
+        }
+    }
+
+    // Number literal at pos, exactly as the JSON grammar allows:
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    std::string parseNumber() {
+        size_t start = pos;
+        auto digits = [&]() {
+            size_t first = pos;
+            while(pos < s.size() && isdigit((unsigned char)s[pos])) pos++;
+            if(pos == first) fail("bad number");
+        };
+        if(s[pos] == '-') pos++;
+        if(pos < s.size() && s[pos] == '0') pos++;
+        else digits();
+        if(pos < s.size() && s[pos] == '.') { pos++; digits(); }
+        if(pos < s.size() && (s[pos] == 'e' || s[pos] == 'E')) {
+            pos++;
+            if(pos < s.size() && (s[pos] == '+' || s[pos] == '-')) pos++;
+            digits();
+        }
+        return s.substr(start, pos - start);
+    }
+
+    // Four hex digits of a \u escape at pos
+    unsigned parseHex4() {
+        if(pos + 4 > s.size()) fail("bad \\u escape");
+        unsigned code = 0;
+        for(int i = 0; i < 4; i++) {
+            char h = s[pos++];
+            if(!isxdigit((unsigned char)h)) fail("bad \\u escape");
+            code = code * 16 + (isdigit((unsigned char)h) ? h - '0' : (tolower(h) - 'a' + 10));
+        }
+        return code;
+    }
+
+    // Parse a quoted string starting at pos, decoding escapes to UTF-8
+    std::string parseString() {
+        std::string out;
+        pos++;
+        while(pos < s.size() && s[pos] != '"') {
+            char ch = s[pos++];
+            if(ch != '\\') { out.push_back(ch); continue; }
+            if(pos >= s.size()) fail("bad escape");
+            char esc = s[pos++];
+            switch(esc) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    // A surrogate pair spells one code point past U+FFFF; lone halves are rejected
+                    unsigned code = parseHex4();
+                    if(code >= 0xDC00 && code <= 0xDFFF) fail("unpaired surrogate");
+                    if(code >= 0xD800 && code <= 0xDBFF) {
+                        if(s.compare(pos, 2, "\\u") != 0) fail("unpaired surrogate");
+                        pos += 2;
+                        unsigned low = parseHex4();
+                        if(low < 0xDC00 || low > 0xDFFF) fail("unpaired surrogate");
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    if(code < 0x80) out.push_back((char)code);
+                    else if(code < 0x800) {
+                        out.push_back((char)(0xC0 | (code >> 6)));
+                        out.push_back((char)(0x80 | (code & 0x3F)));
+                    } else if(code < 0x10000) {
+                        out.push_back((char)(0xE0 | (code >> 12)));
+                        out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                        out.push_back((char)(0x80 | (code & 0x3F)));
+                    } else {
+                        out.push_back((char)(0xF0 | (code >> 18)));
+                        out.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                        out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                        out.push_back((char)(0x80 | (code & 0x3F)));
+                    }
+                    break;
+                }
+                default: fail("bad escape");
+            }
+        }
+        if(pos >= s.size()) fail("unterminated string");
+        pos++;
+        return out;
+    }
+};
+
+inline JsonValue parseJson(const std::string &input) {
+    return JsonParser(input).parseDocument();
+}
+
+#endif
@@ -0,0 +1,440 @@
+/*
+=====================================================================
+PNG WRITER
+---------------------------------------------------------------------
+Self-contained PNG encoder for --render: 8-bit RGB or RGBA, one filter
+per row (None, Sub or Up) picked by minimum absolute sum, and a zlib
+stream of LZ77 (hash chains) plus dynamic Huffman blocks. The image is
+cut into bands of rows that are filtered and compressed on separate
+threads with independent windows, then joined with sync flushes the way
+pigz splits its input; the bands' Adler-32 sums are combined without
+reading the data again.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_PNG_WRITER_H
+#define WORDSEARCH_PNG_WRITER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+/*---------------------------------------------------------------
+  CHECKSUMS
+---------------------------------------------------------------*/
+
+inline uint32_t pngCrc32(const std::string &data, size_t begin, size_t end) {
+    static const std::vector<uint32_t> table = []() {
+        std::vector<uint32_t> t(256);
+        for(uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for(int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for(size_t i = begin; i < end; i++) crc = table[(crc ^ (uint8_t)data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+const uint32_t ADLER_MOD = 65521;
+
+inline uint32_t adler32(const uint8_t *data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while(size > 0) {
+        size_t n = std::min<size_t>(size, 5552);   // largest run before b can overflow
+        size -= n;
+        while(n--) {
+            a += *data++;
+            b += a;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+    return (b << 16) | a;
+}
+
+// Adler-32 of two buffers back to back, from their own sums and the second's length
+inline uint32_t adler32Combine(uint32_t first, uint32_t second, size_t second_size) {
+    uint32_t rem = second_size % ADLER_MOD;
+    uint32_t a = first & 0xFFFF, b = (uint32_t)((uint64_t)rem * a % ADLER_MOD);
+    a += (second & 0xFFFF) + ADLER_MOD - 1;
+    b += (first >> 16) + (second >> 16) + ADLER_MOD - rem;
+    if(a >= ADLER_MOD) a -= ADLER_MOD;
+    if(a >= ADLER_MOD) a -= ADLER_MOD;
+    if(b >= 2 * ADLER_MOD) b -= 2 * ADLER_MOD;
+    if(b >= ADLER_MOD) b -= ADLER_MOD;
+    return (b << 16) | a;
+}
+
+/*---------------------------------------------------------------
+  DEFLATE
+---------------------------------------------------------------*/
+
+const int DEFLATE_WINDOW = 32768;
+const int DEFLATE_HASH_BITS = 15;
+const int DEFLATE_MAX_CHAIN = 16;       // candidates tried per position
+const int DEFLATE_MAX_INSERT = 32;      // longer matches skip indexing their interior
+const int DEFLATE_MIN_MATCH = 3, DEFLATE_MAX_MATCH = 258;
+const size_t DEFLATE_BLOCK_TOKENS = 1 << 16;
+
+const int DEFLATE_LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                     31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int DEFLATE_LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int DEFLATE_DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,    25,
+                                   33,   49,   65,   97,   129,  193,   257,   385,   513,   769,
+                                   1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+const int DEFLATE_DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order in which the code length code lengths are stored
+const int DEFLATE_CLEN_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// LSB-first bit stream, as deflate packs everything but Huffman codes
+struct DeflateBits {
+    std::string out;
+    uint64_t pending = 0;
+    int count = 0;
+
+    void put(uint32_t bits, int n) {
+        pending |= (uint64_t)bits << count;
+        count += n;
+        while(count >= 8) {
+            out.push_back((char)(pending & 0xFF));
+            pending >>= 8;
+            count -= 8;
+        }
+    }
+
+    void align() { if(count > 0) put(0, 8 - count); }
+};
+
+// Canonical length-limited Huffman code for freqs; codes come back
+// bit-reversed, ready for DeflateBits::put
+inline void buildHuffman(const std::vector<uint32_t> &freqs, int max_length, std::vector<uint8_t> &lengths,
+                         std::vector<uint32_t> &codes) {
+    size_t n = freqs.size();
+    lengths.assign(n, 0);
+    codes.assign(n, 0);
+    std::vector<int> used;
+    for(size_t i = 0; i < n; i++)
+        if(freqs[i]) used.push_back((int)i);
+    if(used.empty()) return;
+    if(used.size() == 1) {
+        lengths[used[0]] = 1;
+        return;
+    }
+
+    // Plain Huffman tree depths
+    std::vector<int> parent(2 * used.size(), -1);
+    typedef std::pair<uint64_t, int> Node;
+    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+    for(size_t i = 0; i < used.size(); i++) heap.push({freqs[used[i]], (int)i});
+    int next = used.size();
+    while(heap.size() > 1) {
+        Node a = heap.top(); heap.pop();
+        Node b = heap.top(); heap.pop();
+        parent[a.second] = parent[b.second] = next;
+        heap.push({a.first + b.first, next++});
+    }
+    std::vector<int> depth(next, 0), per_length(64, 0);
+    for(int i = next - 2; i >= 0; i--) depth[i] = depth[parent[i]] + 1;
+    for(size_t i = 0; i < used.size(); i++) per_length[std::min(depth[i], 63)]++;
+
+    // Fold overlong codes back under max_length, keeping the Kraft sum exact
+    for(int len = max_length + 1; len < 64; len++) {
+        per_length[max_length] += per_length[len];
+        per_length[len] = 0;
+    }
+    uint64_t total = 0;
+    for(int len = 1; len <= max_length; len++) total += (uint64_t)per_length[len] << (max_length - len);
+    while(total != (1ULL << max_length)) {
+        per_length[max_length]--;
+        for(int len = max_length - 1; len > 0; len--)
+            if(per_length[len]) {
+                per_length[len]--;
+                per_length[len + 1] += 2;
+                break;
+            }
+        total--;
+    }
+
+    // Shortest codes to the most frequent symbols, then canonical codes
+    std::stable_sort(used.begin(), used.end(), [&](int a, int b) { return freqs[a] > freqs[b]; });
+    size_t k = 0;
+    for(int len = 1; len <= max_length; len++)
+        for(int c = 0; c < per_length[len]; c++) lengths[used[k++]] = len;
+    uint32_t code = 0;
+    for(int len = 1; len <= max_length; len++) {
+        for(size_t i = 0; i < n; i++) {
+            if(lengths[i] != len) continue;
+            uint32_t reversed = 0;
+            for(int b = 0; b < len; b++) reversed |= ((code >> b) & 1) << (len - 1 - b);
+            codes[i] = reversed;
+            code++;
+        }
+        code <<= 1;
+    }
+}
+
+// A literal byte, or a match marked by the top bit: (length << 16) | distance
+typedef std::vector<uint32_t> DeflateTokens;
+const uint32_t DEFLATE_MATCH = 0x80000000u;
+
+inline int deflateLengthCode(int length) {
+    return (int)(std::upper_bound(DEFLATE_LENGTH_BASE, DEFLATE_LENGTH_BASE + 29, length) - DEFLATE_LENGTH_BASE) - 1;
+}
+
+inline int deflateDistCode(int dist) {
+    return (int)(std::upper_bound(DEFLATE_DIST_BASE, DEFLATE_DIST_BASE + 30, dist) - DEFLATE_DIST_BASE) - 1;
+}
+
+// One dynamic-Huffman block holding tokens
+inline void writeDeflateBlock(DeflateBits &bits, const DeflateTokens &tokens, bool final) {
+    std::vector<uint32_t> lit_freq(286, 0), dist_freq(30, 0);
+    for(uint32_t t : tokens) {
+        if(t & DEFLATE_MATCH) {
+            lit_freq[257 + deflateLengthCode((t >> 16) & 0x7FFF)]++;
+            dist_freq[deflateDistCode(t & 0xFFFF)]++;
+        } else {
+            lit_freq[t]++;
+        }
+    }
+    lit_freq[256] = 1;
+    // Decoders want at least two codes in each tree
+    if(std::count_if(lit_freq.begin(), lit_freq.end(), [](uint32_t f) { return f > 0; }) < 2) lit_freq[0]++;
+    if(std::count_if(dist_freq.begin(), dist_freq.end(), [](uint32_t f) { return f > 0; }) < 2)
+        dist_freq[0]++, dist_freq[1]++;
+
+    std::vector<uint8_t> lit_len, dist_len, clen_len;
+    std::vector<uint32_t> lit_code, dist_code, clen_code;
+    buildHuffman(lit_freq, 15, lit_len, lit_code);
+    buildHuffman(dist_freq, 15, dist_len, dist_code);
+    int hlit = 286, hdist = 30;
+    while(hlit > 257 && !lit_len[hlit - 1]) hlit--;
+    while(hdist > 1 && !dist_len[hdist - 1]) hdist--;
+
+    // Run-length code both length tables as one sequence: (symbol, extra bits value)
+    std::vector<uint8_t> all(lit_len.begin(), lit_len.begin() + hlit);
+    all.insert(all.end(), dist_len.begin(), dist_len.begin() + hdist);
+    std::vector<std::pair<int, int>> runs;
+    for(size_t i = 0; i < all.size();) {
+        size_t run = 1;
+        while(i + run < all.size() && all[i + run] == all[i]) run++;
+        size_t left = run;
+        if(all[i] == 0) {
+            while(left >= 11) {
+                int r = (int)std::min<size_t>(left, 138);
+                runs.push_back({18, r - 11});
+                left -= r;
+            }
+            if(left >= 3) {
+                runs.push_back({17, (int)left - 3});
+                left = 0;
+            }
+        } else {
+            runs.push_back({all[i], 0});
+            left--;
+            while(left >= 3) {
+                int r = (int)std::min<size_t>(left, 6);
+                runs.push_back({16, r - 3});
+                left -= r;
+            }
+        }
+        while(left--) runs.push_back({all[i], 0});
+        i += run;
+    }
+    std::vector<uint32_t> clen_freq(19, 0);
+    for(auto &r : runs) clen_freq[r.first]++;
+    buildHuffman(clen_freq, 7, clen_len, clen_code);
+    int hclen = 19;
+    while(hclen > 4 && !clen_len[DEFLATE_CLEN_ORDER[hclen - 1]]) hclen--;
+
+    bits.put(final ? 1 : 0, 1);
+    bits.put(2, 2);
+    bits.put(hlit - 257, 5);
+    bits.put(hdist - 1, 5);
+    bits.put(hclen - 4, 4);
+    for(int i = 0; i < hclen; i++) bits.put(clen_len[DEFLATE_CLEN_ORDER[i]], 3);
+    for(auto &r : runs) {
+        bits.put(clen_code[r.first], clen_len[r.first]);
+        if(r.first == 16) bits.put(r.second, 2);
+        else if(r.first == 17) bits.put(r.second, 3);
+        else if(r.first == 18) bits.put(r.second, 7);
+    }
+
+    for(uint32_t t : tokens) {
+        if(!(t & DEFLATE_MATCH)) {
+            bits.put(lit_code[t], lit_len[t]);
+            continue;
+        }
+        int length = (t >> 16) & 0x7FFF, dist = t & 0xFFFF;
+        int lc = deflateLengthCode(length), dc = deflateDistCode(dist);
+        bits.put(lit_code[257 + lc], lit_len[257 + lc]);
+        bits.put(length - DEFLATE_LENGTH_BASE[lc], DEFLATE_LENGTH_EXTRA[lc]);
+        bits.put(dist_code[dc], dist_len[dc]);
+        bits.put(dist - DEFLATE_DIST_BASE[dc], DEFLATE_DIST_EXTRA[dc]);
+    }
+    bits.put(lit_code[256], lit_len[256]);
+}
+
+// Raw deflate of one band, ending on a byte boundary: the last band closes
+// the stream, any other ends with an empty stored block (a sync flush) so
+// the next band's blocks can simply be appended
+inline std::string deflateBand(const uint8_t *data, size_t size, bool last) {
+    DeflateBits bits;
+    DeflateTokens tokens;
+    tokens.reserve(DEFLATE_BLOCK_TOKENS);
+    std::vector<int32_t> head(1 << DEFLATE_HASH_BITS, -1), prev(DEFLATE_WINDOW, -1);
+    auto hashAt = [&](size_t pos) {
+        uint32_t v = data[pos] | (uint32_t)data[pos + 1] << 8 | (uint32_t)data[pos + 2] << 16;
+        return (v * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+    };
+    auto insert = [&](size_t pos) {
+        uint32_t h = hashAt(pos);
+        prev[pos & (DEFLATE_WINDOW - 1)] = head[h];
+        head[h] = (int32_t)pos;
+    };
+
+    size_t pos = 0;
+    while(pos < size) {
+        int best_length = 0, best_dist = 0;
+        if(pos + DEFLATE_MIN_MATCH <= size) {
+            int limit = (int)std::min<size_t>(DEFLATE_MAX_MATCH, size - pos);
+            int32_t candidate = head[hashAt(pos)];
+            for(int chain = 0; candidate >= 0 && chain < DEFLATE_MAX_CHAIN; chain++) {
+                if(pos - candidate > (size_t)DEFLATE_WINDOW) break;
+                const uint8_t *a = data + pos, *b = data + candidate;
+                if(b[best_length] == a[best_length]) {
+                    int length = 0;
+                    while(length < limit && a[length] == b[length]) length++;
+                    if(length > best_length) {
+                        best_length = length;
+                        best_dist = (int)(pos - candidate);
+                        if(length == limit) break;
+                    }
+                }
+                int32_t older = prev[candidate & (DEFLATE_WINDOW - 1)];
+                if(older >= candidate) break;   // slot reused by a newer position
+                candidate = older;
+            }
+            insert(pos);
+        }
+
+        if(best_length >= DEFLATE_MIN_MATCH) {
+            tokens.push_back(DEFLATE_MATCH | (uint32_t)best_length << 16 | (uint32_t)best_dist);
+            if(best_length <= DEFLATE_MAX_INSERT)
+                for(size_t p = pos + 1; p < pos + best_length && p + DEFLATE_MIN_MATCH <= size; p++) insert(p);
+            pos += best_length;
+        } else {
+            tokens.push_back(data[pos]);
+            pos++;
+        }
+        if(tokens.size() >= DEFLATE_BLOCK_TOKENS && pos < size) {
+            writeDeflateBlock(bits, tokens, false);
+            tokens.clear();
+        }
+    }
+    writeDeflateBlock(bits, tokens, last);
+    if(!last) {
+        bits.put(0, 3);
+        bits.align();
+        bits.out.append("\x00\x00\xFF\xFF", 4);
+    }
+    bits.align();
+    return bits.out;
+}
+
+/*---------------------------------------------------------------
+  PNG ENCODING
+---------------------------------------------------------------*/
+
+// Scanlines row_begin..row_end with their filter bytes, each row filtered
+// with whichever of None, Sub and Up has the smallest absolute sum. Paeth
+// is left out: on flat pages of glyphs it barely helps and costs most of
+// the filtering time
+inline std::vector<uint8_t> filterPngRows(const std::vector<uint8_t> &pixels, int width, int channels,
+                                          int row_begin, int row_end) {
+    size_t row_bytes = (size_t)width * channels;
+    std::vector<uint8_t> out;
+    out.reserve((row_end - row_begin) * (row_bytes + 1));
+    std::vector<uint8_t> sub(row_bytes), vertical(row_bytes), zero_row(row_bytes, 0);
+    for(int row = row_begin; row < row_end; row++) {
+        const uint8_t *cur = pixels.data() + row * row_bytes;
+        const uint8_t *up = row > 0 ? cur - row_bytes : zero_row.data();
+        // Both filters and all three sums in one pass; the first pixel has no left neighbour
+        long long sums[3] = {0, 0, 0};
+        for(size_t i = 0; i < row_bytes; i++) {
+            uint8_t left = i >= (size_t)channels ? cur[i - channels] : 0;
+            sub[i] = cur[i] - left;
+            vertical[i] = cur[i] - up[i];
+            sums[0] += std::abs((int)(int8_t)cur[i]);
+            sums[1] += std::abs((int)(int8_t)sub[i]);
+            sums[2] += std::abs((int)(int8_t)vertical[i]);
+        }
+        const uint8_t *rows[3] = {cur, sub.data(), vertical.data()};
+        int best = (int)(std::min_element(sums, sums + 3) - sums);
+        out.push_back((uint8_t)best);   // filter types 0, 1 and 2
+        out.insert(out.end(), rows[best], rows[best] + row_bytes);
+    }
+    return out;
+}
+
+inline void pngPut32(std::string &out, uint32_t v) {
+    for(int shift = 24; shift >= 0; shift -= 8) out.push_back((char)((v >> shift) & 0xFF));
+}
+
+inline void pngChunk(std::string &out, const char *type, const std::string &data) {
+    pngPut32(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.append(type, 4);
+    out.append(data);
+    pngPut32(out, pngCrc32(out, start, out.size()));
+}
+
+// PNG file for 8-bit pixels, row-major and top row first, with channels 3
+// (RGB) or 4 (RGBA); the rows are compressed in up to threads bands at once
+inline std::string encodePng(const std::vector<uint8_t> &pixels, int width, int height, int channels, int threads) {
+    int bands = std::max(1, std::min(threads, height / 16));
+    std::vector<std::string> compressed(bands);
+    std::vector<uint32_t> sums(bands);
+    std::vector<size_t> sizes(bands);
+    auto compressBand = [&](int band) {
+        int row_begin = (int)((long long)height * band / bands), row_end = (int)((long long)height * (band + 1) / bands);
+        std::vector<uint8_t> filtered = filterPngRows(pixels, width, channels, row_begin, row_end);
+        sums[band] = adler32(filtered.data(), filtered.size());
+        sizes[band] = filtered.size();
+        compressed[band] = deflateBand(filtered.data(), filtered.size(), band == bands - 1);
+    };
+    std::vector<std::thread> workers;
+    for(int band = 1; band < bands; band++) workers.emplace_back(compressBand, band);
+    compressBand(0);
+    for(auto &w : workers) w.join();
+
+    std::string zlib = "\x78\x01";
+    uint32_t adler = sums[0];
+    for(int band = 0; band < bands; band++) {
+        zlib += compressed[band];
+        if(band > 0) adler = adler32Combine(adler, sums[band], sizes[band]);
+    }
+    pngPut32(zlib, adler);
+
+    std::string header;
+    pngPut32(header, (uint32_t)width);
+    pngPut32(header, (uint32_t)height);
+    header.push_back(8);                              // bit depth
+    header.push_back(channels == 4 ? 6 : 2);          // RGBA or RGB
+    header.append(3, '\0');                           // deflate, adaptive filters, no interlace
+    std::string png = "\x89PNG\r\n\x1a\n";
+    pngChunk(png, "IHDR", header);
+    pngChunk(png, "IDAT", zlib);
+    pngChunk(png, "IEND", "");
+    return png;
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+=====================================================================
+PUZZLE RENDERING (--render=png)
+---------------------------------------------------------------------
+Draws a solved puzzle on a 300 DPI page with the Streamlit app's layout:
+letters centred in square cells inside a 6% margin, over a vertical
+gradient from the background colour to light grey (or a transparent
+page), plus a solution copy with every placed word's cells outlined in
+red. Each letter is rasterized once (truetype.h) into a glyph atlas and
+blitted per cell, both images come from the same layout, and each is
+PNG-encoded on several threads (png_writer.h).
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_PUZZLE_RENDER_H
+#define WORDSEARCH_PUZZLE_RENDER_H
+
+#include "libwordsearch.h"
+#include "truetype.h"
+#include "png_writer.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+struct RenderOptions {
+    bool enabled = false;
+    std::string out_base = "wordsearch";   // writes <base>.png and <base>_solution.png
+    std::string page = "A4";
+    std::string font_path = "Aaargh.ttf";
+    int font_size = 72;                    // em size in page pixels
+    uint8_t fg[3] = {255, 255, 255}, bg[3] = {0, 0, 0};
+    bool transparent = false;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+};
+
+// #RGB or #RRGGBB (the # optional) into rgb; false if malformed
+inline bool parseHexColor(std::string text, uint8_t rgb[3]) {
+    if(!text.empty() && text[0] == '#') text = text.substr(1);
+    if(text.size() == 3) text = std::string{text[0], text[0], text[1], text[1], text[2], text[2]};
+    if(text.size() != 6 || text.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) return false;
+    for(int i = 0; i < 3; i++) rgb[i] = (uint8_t)std::stoi(text.substr(2 * i, 2), nullptr, 16);
+    return true;
+}
+
+// Apply a rendering option; false if arg is not one, throws
+// invalid_argument on a bad value
+inline bool applyRenderFlag(const std::string &arg, RenderOptions &options) {
+    auto value = [&](size_t prefix) { return arg.substr(prefix); };
+    if(arg == "--render=png") options.enabled = true;
+    else if(arg.rfind("--render=", 0) == 0)
+        throw std::invalid_argument("Unknown render format: " + value(9) + " (expected png)");
+    else if(arg.rfind("--render-out=", 0) == 0) options.out_base = value(13);
+    else if(arg.rfind("--page=", 0) == 0) {
+        options.page = value(7);
+        if(options.page != "A5" && options.page != "A4" && options.page != "A3")
+            throw std::invalid_argument("Unknown page size: " + options.page + " (expected A5, A4 or A3)");
+    }
+    else if(arg.rfind("--font=", 0) == 0) options.font_path = value(7);
+    else if(arg.rfind("--font-size=", 0) == 0) options.font_size = std::max(1, std::stoi(value(12)));
+    else if(arg.rfind("--fg=", 0) == 0) {
+        if(!parseHexColor(value(5), options.fg)) throw std::invalid_argument("Bad --fg colour: " + value(5));
+    }
+    else if(arg.rfind("--bg=", 0) == 0) {
+        if(!parseHexColor(value(5), options.bg)) throw std::invalid_argument("Bad --bg colour: " + value(5));
+    }
+    else if(arg == "--transparent") options.transparent = true;
+    else return false;
+    return true;
+}
+
+// Page-sized pixel buffer, RGB or (transparent pages) RGBA
+struct RenderCanvas {
+    int width = 0, height = 0, channels = 3;
+    std::vector<uint8_t> pixels;
+
+    uint8_t *at(int x, int y) { return pixels.data() + ((size_t)y * width + x) * channels; }
+
+    // Composite colour over pixel (x, y) with coverage 0-255
+    void blend(int x, int y, const uint8_t rgb[3], int coverage) {
+        if(coverage <= 0 || x < 0 || y < 0 || x >= width || y >= height) return;
+        uint8_t *p = at(x, y);
+        if(channels == 3) {
+            for(int i = 0; i < 3; i++) p[i] = (uint8_t)((p[i] * (255 - coverage) + rgb[i] * coverage + 127) / 255);
+            return;
+        }
+        float a = coverage / 255.0f, below = p[3] / 255.0f, out = a + below * (1 - a);
+        for(int i = 0; i < 3; i++) p[i] = (uint8_t)((rgb[i] * a + p[i] * below * (1 - a)) / out + 0.5f);
+        p[3] = (uint8_t)(out * 255.0f + 0.5f);
+    }
+};
+
+// Cell layout of a grid on the page, as the app computes it
+struct RenderLayout {
+    int cell = 0, start_x = 0, start_y = 0;
+};
+
+inline RenderLayout layoutGrid(int page_width, int page_height, int rows, int cols) {
+    RenderLayout layout;
+    int margin = (int)(std::min(page_width, page_height) * 0.06);
+    layout.cell = std::max(1, std::min((page_width - 2 * margin) / std::max(1, cols),
+                                       (page_height - 2 * margin) / std::max(1, rows)));
+    layout.start_x = (page_width - layout.cell * cols) / 2;
+    layout.start_y = (page_height - layout.cell * rows) / 2;
+    return layout;
+}
+
+inline bool writeFile(const std::string &path, const std::string &bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+    return (bool)file;
+}
+
+// Render result (a solve of words) into options.out_base + ".png" and
+// "_solution.png"; false with a message in error on failure
+inline bool renderPuzzlePng(const wordsearch::PuzzleResult &result, const std::vector<std::string> &words,
+                            const RenderOptions &options, std::string &error) {
+    TrueTypeFont font;
+    if(!font.load(options.font_path)) {
+        error = "cannot load TrueType font " + options.font_path;
+        return false;
+    }
+
+    RenderCanvas canvas;
+    canvas.width = options.page == "A5" ? 1748 : options.page == "A3" ? 3508 : 2480;
+    canvas.height = options.page == "A5" ? 2480 : options.page == "A3" ? 4961 : 3508;
+    canvas.channels = options.transparent ? 4 : 3;
+    canvas.pixels.resize((size_t)canvas.width * canvas.height * canvas.channels);
+
+    // Background: white at zero alpha, or one gradient colour per row
+    for(int y = 0; y < canvas.height; y++) {
+        uint8_t row_colour[4] = {255, 255, 255, 0};
+        if(!options.transparent) {
+            float t = (float)y / std::max(1, canvas.height - 1);
+            for(int i = 0; i < 3; i++) row_colour[i] = (uint8_t)(options.bg[i] + (240 - options.bg[i]) * t);
+        }
+        uint8_t *row = canvas.at(0, y);
+        for(int x = 0; x < canvas.width; x++)
+            std::copy(row_colour, row_colour + canvas.channels, row + (size_t)x * canvas.channels);
+    }
+
+    // Letters, each rasterized once, centred in its cell by its ink box
+    const wordsearch::Grid &grid = result.grid;
+    RenderLayout layout = layoutGrid(canvas.width, canvas.height, grid.rows, grid.cols);
+    std::vector<TrueTypeFont::GlyphBitmap> atlas(256);
+    std::vector<bool> rasterized(256, false);
+    for(int r = 0; r < grid.rows; r++)
+        for(int c = 0; c < grid.cols; c++) {
+            uint8_t letter = (uint8_t)grid.at(r, c);
+            if(!rasterized[letter]) {
+                atlas[letter] = font.rasterize(letter, (float)options.font_size);
+                rasterized[letter] = true;
+            }
+            const TrueTypeFont::GlyphBitmap &glyph = atlas[letter];
+            int x = layout.start_x + c * layout.cell, y = layout.start_y + r * layout.cell;
+            int origin_x = (int)std::lround(x + (layout.cell - glyph.ink_right) / 2);
+            int origin_y = (int)std::lround(y + (layout.cell - glyph.ink_bottom) / 2);
+            for(int gy = 0; gy < glyph.height; gy++)
+                for(int gx = 0; gx < glyph.width; gx++)
+                    canvas.blend(origin_x + glyph.left + gx, origin_y + glyph.top + gy, options.fg,
+                                 glyph.coverage[(size_t)gy * glyph.width + gx]);
+        }
+    std::string puzzle_png = encodePng(canvas.pixels, canvas.width, canvas.height, canvas.channels, options.threads);
+
+    // Solution: the same page with a 3-pixel red box inside every cell of every placed word
+    static const uint8_t RED[3] = {255, 0, 0};
+    for(auto &p : result.placements)
+        for(size_t k = 0; k < words[p.word_index].size(); k++) {
+            int x0 = layout.start_x + (p.col + (int)k * p.delta_col) * layout.cell + 2;
+            int y0 = layout.start_y + (p.row + (int)k * p.delta_row) * layout.cell + 2;
+            int x1 = x0 + layout.cell - 5, y1 = y0 + layout.cell - 5;
+            for(int y = y0; y <= y1; y++)
+                for(int x = x0; x <= x1; x++)
+                    if(x < x0 + 3 || x > x1 - 3 || y < y0 + 3 || y > y1 - 3) canvas.blend(x, y, RED, 255);
+        }
+    std::string solution_png = encodePng(canvas.pixels, canvas.width, canvas.height, canvas.channels, options.threads);
+
+    for(auto &file : {std::make_pair(options.out_base + ".png", &puzzle_png),
+                      std::make_pair(options.out_base + "_solution.png", &solution_png)})
+        if(!writeFile(file.first, *file.second)) {
+            error = "cannot write " + file.first;
+            return false;
+        }
+    return true;
+}
+
+#endif
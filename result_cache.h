@@ -0,0 +1,289 @@
+/*
+=====================================================================
+RESULT CACHE
+---------------------------------------------------------------------
+LRU cache of solved puzzles for server and batch modes (--cache=N),
+keyed by the sorted normalized words with their required flags, the
+grid size, the fill seed and every solver setting that changes the
+result (engine, ordering, threads and parallel mode), so the same list
+in any order hits. The search budget is not part of the key: each entry
+records the time or node budget it was solved with and only answers
+requests asking for no more. Placements are stored by word text and
+mapped back onto the request's own word order on a hit. With
+--cache-file every new entry is also appended to a JSONL journal, which
+is replayed and compacted at startup and compacted again whenever it
+grows past twice the live entries.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_RESULT_CACHE_H
+#define WORDSEARCH_RESULT_CACHE_H
+
+#include "libwordsearch.h"
+#include "json_writer.h"
+#include "minijson.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <fstream>
+#include <random>
+#include <chrono>
+
+class ResultCache {
+public:
+    struct Placement {
+        std::string word;
+        int row, col, delta_row, delta_col;
+    };
+
+    // A solved puzzle independent of the order its words came in
+    struct Entry {
+        int rows = 0, cols = 0;
+        std::string cells;    // the filled grid, row-major
+        std::vector<Placement> placements;
+        int required = 0, placed = 0, overlap = 0;
+        long long budget = 0; // runtime_ms or node_budget of the solve, see budgetOf
+    };
+
+    bool refill = false;      // hits get a fresh random fill (--cache-refill)
+    bool warm = false;        // hits seed a solve that tries to beat them (--cache-warm)
+
+    explicit ResultCache(size_t max_entries) : capacity(max_entries) {}
+
+    // Canonical key of a request; config must have its final rows and cols
+    static std::string key(const std::vector<std::string> &words, const std::vector<bool> &required_flags,
+                           const wordsearch::SolverConfig &config) {
+        std::vector<std::string> marked;
+        for(size_t i = 0; i < words.size(); i++) marked.push_back((required_flags[i] ? "*" : "") + words[i]);
+        std::sort(marked.begin(), marked.end());
+        std::string text;
+        for(auto &w : marked) text += w + ",";
+        text += "|" + std::to_string(config.rows) + "x" + std::to_string(config.cols) + "|" +
+                std::to_string((int)config.engine) + "|" + std::to_string(config.seed) + "|" +
+                std::to_string((int)config.ordering) + "|" + std::to_string(config.threads) + "|" +
+                std::to_string((int)config.parallel) + "|" + std::to_string(config.split_depth) + "|" +
+                std::to_string(config.transposition_bits) + "|" + (config.stop_at_required ? "s" : "") +
+                (config.node_budget > 0 ? "n" : "t");
+        return text;
+    }
+
+    // The budget an entry solved with must be at least the request's; the
+    // key already tells node budgets from time limits apart
+    static long long budgetOf(const wordsearch::SolverConfig &config) {
+        return config.node_budget > 0 ? config.node_budget : config.runtime_ms;
+    }
+
+    static Entry fromResult(const wordsearch::PuzzleResult &result, const std::vector<std::string> &words,
+                            long long budget) {
+        Entry entry;
+        entry.budget = budget;
+        entry.rows = result.grid.rows;
+        entry.cols = result.grid.cols;
+        for(int r = 0; r < entry.rows; r++)
+            entry.cells.append(result.grid.cells.data() + result.grid.index(r, 0), entry.cols);
+        for(auto &p : result.placements)
+            entry.placements.push_back({words[p.word_index], p.row, p.col, p.delta_row, p.delta_col});
+        entry.required = result.num_required_placed;
+        entry.placed = result.num_placed;
+        entry.overlap = result.total_overlap_score;
+        return entry;
+    }
+
+    // The entry's placements as a warm start for this request's word order
+    static std::vector<wordsearch::WordPlacement> placementsFor(const Entry &entry,
+                                                                const std::vector<std::string> &words) {
+        std::vector<std::string> old_words;
+        std::vector<wordsearch::WordPlacement> old_placements;
+        for(auto &p : entry.placements) {
+            old_placements.push_back({(int)old_words.size(), p.row, p.col, p.delta_row, p.delta_col});
+            old_words.push_back(p.word);
+        }
+        return wordsearch::carryOverPlacements(old_words, old_placements, words);
+    }
+
+    // Rebuild a result for this request's word order. With refill the cells
+    // no word passes through get fresh random letters (seeded like a solve).
+    // Its stats stay empty, so replies leave them out
+    static wordsearch::PuzzleResult toResult(const Entry &entry, const std::vector<std::string> &words,
+                                             bool refill, uint64_t seed) {
+        wordsearch::PuzzleResult result;
+        result.grid = wordsearch::Grid(entry.rows, entry.cols);
+        std::map<std::string, std::deque<int>> indices;
+        for(int i = 0; i < (int)words.size(); i++) indices[words[i]].push_back(i);
+        std::vector<bool> placed(words.size(), false), covered(entry.cells.size(), false);
+        for(auto &p : entry.placements) {
+            auto &queue = indices[p.word];
+            if(queue.empty()) continue;
+            int index = queue.front();
+            queue.pop_front();
+            placed[index] = true;
+            result.placements.push_back({index, p.row, p.col, p.delta_row, p.delta_col});
+            for(size_t k = 0; k < p.word.size(); k++)
+                covered[(p.row + k * p.delta_row) * entry.cols + p.col + k * p.delta_col] = true;
+        }
+
+        std::mt19937_64 rng(seed ? seed : (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+        std::uniform_int_distribution<int> dist(0, 25);
+        for(int r = 0; r < entry.rows; r++)
+            for(int c = 0; c < entry.cols; c++) {
+                int cell = r * entry.cols + c;
+                result.grid.at(r, c) = refill && !covered[cell] ? char('A' + dist(rng)) : entry.cells[cell];
+            }
+        for(size_t i = 0; i < words.size(); i++)
+            (placed[i] ? result.placed_words : result.unplaced_words).push_back(words[i]);
+        result.num_required_placed = entry.required;
+        result.num_placed = entry.placed;
+        result.total_overlap_score = entry.overlap;
+        return result;
+    }
+
+    // Copy out the entry for key if it was solved with at least min_budget
+    // and mark it most recently used
+    bool find(const std::string &key, long long min_budget, Entry &entry) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(key);
+        if(it == index.end() || it->second->second.budget < min_budget) return false;
+        order.splice(order.begin(), order, it->second);
+        entry = it->second->second;
+        return true;
+    }
+
+    void insert(const std::string &key, const Entry &entry) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(!store(key, entry) || !journal.is_open()) return;
+        journal << journalLine(key, entry) << '\n';
+        journal.flush();
+        // Replaced and evicted entries leave dead lines behind
+        if(++journal_lines > 2 * std::max<size_t>(order.size(), 16)) rewriteJournal();
+    }
+
+    // Replay the journal at path, rewrite it with just the surviving
+    // entries, and append new entries to it from now on; false if it cannot
+    // be written
+    bool open(const std::string &path) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::ifstream in(path);
+        std::string line;
+        while(in && std::getline(in, line)) {
+            try {
+                JsonValue value = parseJson(line);
+                const JsonValue *key = value.find("key");
+                Entry entry;
+                if(key && key->type == JsonValue::JSON_STRING && parseEntry(value, entry)) store(key->text, entry);
+            } catch(const std::exception &) {
+                // A torn last line from an interrupted run; skip it
+            }
+        }
+        in.close();
+        journal_path = path;
+        return rewriteJournal();
+    }
+
+private:
+    typedef std::list<std::pair<std::string, Entry>> EntryList;
+
+    size_t capacity;
+    std::mutex lock;
+    EntryList order;    // most recently used first
+    std::unordered_map<std::string, EntryList::iterator> index;
+    std::ofstream journal;
+    std::string journal_path;
+    size_t journal_lines = 0;    // lines in the journal, live or not
+
+    // Record entry under key unless the cached one had a larger budget
+    bool store(const std::string &key, const Entry &entry) {
+        auto it = index.find(key);
+        if(it != index.end()) {
+            order.splice(order.begin(), order, it->second);
+            if(it->second->second.budget > entry.budget) return false;
+            it->second->second = entry;
+            return true;
+        }
+        order.emplace_front(key, entry);
+        index[key] = order.begin();
+        while(order.size() > capacity) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+        return true;
+    }
+
+    // Truncate the journal to the live entries, most recently used last so
+    // a replay restores the same LRU order; false if it cannot be written
+    bool rewriteJournal() {
+        if(journal.is_open()) journal.close();
+        journal.open(journal_path, std::ios::trunc);
+        if(!journal) return false;
+        for(auto it = order.rbegin(); it != order.rend(); ++it) journal << journalLine(it->first, it->second) << '\n';
+        journal.flush();
+        journal_lines = order.size();
+        return true;
+    }
+
+    static std::string journalLine(const std::string &key, const Entry &entry) {
+        JsonWriter out;
+        out.raw("{\"key\":"); out.string(key);
+        out.raw(",\"rows\":"); out.integer(entry.rows);
+        out.raw(",\"cols\":"); out.integer(entry.cols);
+        out.raw(",\"cells\":"); out.string(entry.cells);
+        out.raw(",\"required\":"); out.integer(entry.required);
+        out.raw(",\"placed\":"); out.integer(entry.placed);
+        out.raw(",\"overlap\":"); out.integer(entry.overlap);
+        out.raw(",\"budget\":"); out.integer(entry.budget);
+        out.raw(",\"placements\":[");
+        for(size_t i = 0; i < entry.placements.size(); i++) {
+            auto &p = entry.placements[i];
+            if(i) out.raw(',');
+            out.raw('['); out.string(p.word);
+            out.raw(','); out.integer(p.row);
+            out.raw(','); out.integer(p.col);
+            out.raw(','); out.integer(p.delta_row);
+            out.raw(','); out.integer(p.delta_col);
+            out.raw(']');
+        }
+        out.raw("]}");
+        return out.buffer;
+    }
+
+    // Entry from a journal line; false if it is malformed or inconsistent
+    static bool parseEntry(const JsonValue &value, Entry &entry) {
+        auto number = [&](const char *name, int &target) {
+            const JsonValue *v = value.find(name);
+            if(!v || v->type != JsonValue::JSON_NUMBER) return false;
+            target = (int)v->number;
+            return true;
+        };
+        const JsonValue *cells = value.find("cells"), *placements = value.find("placements");
+        if(!number("rows", entry.rows) || !number("cols", entry.cols) || !number("required", entry.required) ||
+           !number("placed", entry.placed) || !number("overlap", entry.overlap) || !cells ||
+           cells->type != JsonValue::JSON_STRING || !placements || placements->type != JsonValue::JSON_ARRAY)
+            return false;
+        // Journals written before budgets were recorded only serve warm starts
+        const JsonValue *budget = value.find("budget");
+        if(budget && budget->type == JsonValue::JSON_NUMBER) entry.budget = (long long)budget->number;
+        entry.cells = cells->text;
+        if(entry.rows <= 0 || entry.cols <= 0 || (int)entry.cells.size() != entry.rows * entry.cols) return false;
+        for(auto &item : placements->items) {
+            if(item.type != JsonValue::JSON_ARRAY || item.items.size() != 5 ||
+               item.items[0].type != JsonValue::JSON_STRING)
+                return false;
+            Placement p{item.items[0].text, (int)item.items[1].number, (int)item.items[2].number,
+                        (int)item.items[3].number, (int)item.items[4].number};
+            int length = p.word.size(), end_row = p.row + (length - 1) * p.delta_row,
+                end_col = p.col + (length - 1) * p.delta_col;
+            if(length == 0 || p.row < 0 || p.row >= entry.rows || p.col < 0 || p.col >= entry.cols ||
+               end_row < 0 || end_row >= entry.rows || end_col < 0 || end_col >= entry.cols)
+                return false;
+            entry.placements.push_back(p);
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+=====================================================================
+THREAD POOL
+---------------------------------------------------------------------
+Fixed set of worker threads draining a FIFO queue of jobs. Used by the
+CLI's server and batch modes to run several puzzles at once.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_THREAD_POOL_H
+#define WORDSEARCH_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int thread_count) {
+        if(thread_count < 1) thread_count = 1;
+        for(int i = 0; i < thread_count; i++)
+            workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    // Finishes every queued job before joining the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto &w : workers) w.join();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // Block until the queue is empty and no job is running
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this]() { return jobs.empty() && running == 0; });
+    }
+
+private:
+    void workerLoop() {
+        std::unique_lock<std::mutex> guard(lock);
+        for(;;) {
+            wake.wait(guard, [this]() { return stopping || !jobs.empty(); });
+            if(jobs.empty()) return;
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            running++;
+            guard.unlock();
+            job();
+            guard.lock();
+            running--;
+            if(jobs.empty() && running == 0) idle.notify_all();
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable wake, idle;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    int running = 0;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,351 @@
+/*
+=====================================================================
+TRUETYPE GLYPHS
+---------------------------------------------------------------------
+Minimal reader for TrueType (glyf) fonts, enough for --render: maps
+characters through the cmap (formats 4 and 12), decodes simple and
+composite glyph outlines, and rasterizes a glyph at a pixel size into an
+anti-aliased coverage bitmap by accumulating the signed area each outline
+edge sweeps through every pixel. No hinting, kerning or CFF outlines.
+=====================================================================
+*/
+
+#ifndef WORDSEARCH_TRUETYPE_H
+#define WORDSEARCH_TRUETYPE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class TrueTypeFont {
+public:
+    // Coverage (0-255) of one glyph. Bitmap pixel (0, 0) sits at (left, top)
+    // from the pen origin on the ascender line, y growing down; ink_right
+    // and ink_bottom are the far edges of the outline's box from the origin
+    struct GlyphBitmap {
+        int width = 0, height = 0;
+        int left = 0, top = 0;
+        float ink_right = 0, ink_bottom = 0;
+        std::vector<uint8_t> coverage;
+    };
+
+    int units_per_em = 0, ascender = 0, descender = 0;
+
+    // False if the file is unreadable or not a TrueType-outline font
+    bool load(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if(!file) return false;
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if(data.size() < 12) return false;
+        int tables = u16(4);
+        for(int i = 0; i < tables; i++) {
+            size_t record = 12 + 16 * i;
+            std::string tag = data.substr(record, 4);
+            uint32_t offset = u32(record + 8), length = u32(record + 12);
+            if((uint64_t)offset + length > data.size()) return false;
+            if(tag == "head") head = offset;
+            else if(tag == "maxp") maxp = offset;
+            else if(tag == "cmap") cmap = offset;
+            else if(tag == "loca") loca = offset;
+            else if(tag == "glyf") glyf = offset;
+            else if(tag == "hhea") hhea = offset;
+        }
+        if(!head || !maxp || !cmap || !loca || !glyf || !hhea) return false;
+        units_per_em = u16(head + 18);
+        long_loca = s16(head + 50) != 0;
+        glyph_count = u16(maxp + 4);
+        ascender = s16(hhea + 4);
+        descender = s16(hhea + 6);
+        return units_per_em > 0 && findCmap();
+    }
+
+    // Glyph id of a character, 0 (the missing glyph) when the font has none
+    int glyphIndex(uint32_t codepoint) const {
+        if(cmap_format == 4) {
+            int segments = u16(cmap_table + 6) / 2;
+            size_t ends = cmap_table + 14, starts = ends + 2 * segments + 2;
+            size_t deltas = starts + 2 * segments, ranges = deltas + 2 * segments;
+            for(int i = 0; i < segments; i++) {
+                if(u16(ends + 2 * i) < codepoint) continue;
+                uint32_t start = u16(starts + 2 * i);
+                if(start > codepoint) return 0;
+                int delta = s16(deltas + 2 * i), range = u16(ranges + 2 * i);
+                if(!range) return (codepoint + delta) & 0xFFFF;
+                int glyph = u16(ranges + 2 * i + range + 2 * (codepoint - start));
+                return glyph ? (glyph + delta) & 0xFFFF : 0;
+            }
+        } else if(cmap_format == 12) {
+            uint32_t groups = u32(cmap_table + 12);
+            for(uint32_t i = 0; i < groups; i++) {
+                size_t group = cmap_table + 16 + 12 * i;
+                if(codepoint >= u32(group) && codepoint <= u32(group + 4)) return u32(group + 8) + codepoint - u32(group);
+            }
+        }
+        return 0;
+    }
+
+    // Rasterize a character so that the em square is pixel_size pixels tall
+    GlyphBitmap rasterize(uint32_t codepoint, float pixel_size) const {
+        GlyphBitmap bitmap;
+        std::vector<Contour> contours;
+        glyphContours(glyphIndex(codepoint), 1, 0, 0, 1, 0, 0, contours, 0);
+        float scale = pixel_size / units_per_em, ascent = ascender * scale;
+        float x_min = 1e30f, x_max = -1e30f, y_min = 1e30f, y_max = -1e30f;
+        for(auto &contour : contours)
+            for(auto &p : contour) {
+                x_min = std::min(x_min, p.x); x_max = std::max(x_max, p.x);
+                y_min = std::min(y_min, p.y); y_max = std::max(y_max, p.y);
+            }
+        if(x_min > x_max) return bitmap;   // blank glyph such as a space
+
+        bitmap.left = (int)std::floor(x_min * scale);
+        bitmap.top = (int)std::floor(ascent - y_max * scale);
+        bitmap.ink_right = x_max * scale;
+        bitmap.ink_bottom = ascent - y_min * scale;
+        bitmap.width = (int)std::ceil(bitmap.ink_right) - bitmap.left + 1;
+        bitmap.height = (int)std::ceil(bitmap.ink_bottom) - bitmap.top + 1;
+
+        // Outline in bitmap pixels, quadratic arcs flattened into lines
+        Accumulator acc(bitmap.width, bitmap.height);
+        auto toPixel = [&](const Point &p) {
+            return Point{p.x * scale - bitmap.left, ascent - p.y * scale - bitmap.top, p.on_curve};
+        };
+        for(auto &contour : contours) {
+            std::vector<Point> points;
+            for(auto &p : contour) points.push_back(toPixel(p));
+            walkContour(points, acc);
+        }
+        bitmap.coverage = acc.coverage();
+        return bitmap;
+    }
+
+private:
+    struct Point {
+        float x, y;
+        bool on_curve;
+    };
+    typedef std::vector<Point> Contour;
+
+    std::string data;
+    uint32_t head = 0, maxp = 0, cmap = 0, loca = 0, glyf = 0, hhea = 0;
+    size_t cmap_table = 0;
+    int cmap_format = 0, glyph_count = 0;
+    bool long_loca = false;
+
+    // Big-endian reads that yield 0 past the end instead of overrunning
+    uint32_t u8(size_t at) const { return at < data.size() ? (uint8_t)data[at] : 0; }
+    uint32_t u16(size_t at) const { return u8(at) << 8 | u8(at + 1); }
+    int s16(size_t at) const { return (int16_t)u16(at); }
+    uint32_t u32(size_t at) const { return u16(at) << 16 | u16(at + 2); }
+
+    // Prefer a full-Unicode format 12 subtable, then a BMP format 4 one
+    bool findCmap() {
+        int subtables = u16(cmap + 2);
+        for(int want : {12, 4})
+            for(int i = 0; i < subtables; i++) {
+                int platform = u16(cmap + 4 + 8 * i), encoding = u16(cmap + 6 + 8 * i);
+                size_t table = cmap + u32(cmap + 8 + 8 * i);
+                bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+                if(unicode && (int)u16(table) == want) {
+                    cmap_table = table;
+                    cmap_format = want;
+                    return true;
+                }
+            }
+        return false;
+    }
+
+    // Append a glyph's contours in font units, mapped through the 2x2
+    // transform (a b; c d) and offset (dx, dy) of the composites holding it
+    void glyphContours(int glyph, float a, float b, float c, float d, float dx, float dy,
+                       std::vector<Contour> &contours, int depth) const {
+        if(glyph < 0 || glyph >= glyph_count || depth > 8) return;
+        size_t start = long_loca ? u32(loca + 4 * glyph) : u16(loca + 2 * glyph) * 2;
+        size_t end = long_loca ? u32(loca + 4 * glyph + 4) : u16(loca + 2 * glyph + 2) * 2;
+        if(end <= start) return;
+        size_t at = glyf + start;
+        int contour_count = s16(at);
+        auto place = [&](float x, float y, bool on) { return Point{a * x + c * y + dx, b * x + d * y + dy, on}; };
+
+        if(contour_count >= 0) {
+            std::vector<int> ends;
+            for(int i = 0; i < contour_count; i++) ends.push_back(u16(at + 10 + 2 * i));
+            int points = ends.empty() ? 0 : ends.back() + 1;
+            size_t p = at + 10 + 2 * contour_count;
+            p += 2 + u16(p);   // skip the hinting instructions
+            std::vector<uint8_t> flags;
+            while((int)flags.size() < points && p < data.size()) {
+                uint8_t flag = u8(p++);
+                flags.push_back(flag);
+                if(flag & 8)
+                    for(int repeat = u8(p++); repeat > 0 && (int)flags.size() < points; repeat--) flags.push_back(flag);
+            }
+            if((int)flags.size() < points) return;
+            std::vector<int> xs(points), ys(points);
+            int value = 0;
+            for(int i = 0; i < points; i++) {
+                if(flags[i] & 2) value += flags[i] & 16 ? (int)u8(p++) : -(int)u8(p++);
+                else if(!(flags[i] & 16)) { value += s16(p); p += 2; }
+                xs[i] = value;
+            }
+            value = 0;
+            for(int i = 0; i < points; i++) {
+                if(flags[i] & 4) value += flags[i] & 32 ? (int)u8(p++) : -(int)u8(p++);
+                else if(!(flags[i] & 32)) { value += s16(p); p += 2; }
+                ys[i] = value;
+            }
+            int first = 0;
+            for(int e : ends) {
+                Contour contour;
+                for(int i = first; i <= e && i < points; i++) contour.push_back(place(xs[i], ys[i], flags[i] & 1));
+                if(contour.size() > 1) contours.push_back(contour);
+                first = e + 1;
+            }
+            return;
+        }
+
+        // Composite: transformed copies of other glyphs
+        size_t p = at + 10;
+        for(;;) {
+            int flags = u16(p), component = u16(p + 2);
+            p += 4;
+            float ox, oy;
+            if(flags & 1) { ox = s16(p); oy = s16(p + 2); p += 4; }
+            else { ox = (int8_t)u8(p); oy = (int8_t)u8(p + 1); p += 2; }
+            if(!(flags & 2)) ox = oy = 0;   // point-matched anchors are not supported
+            float ca = 1, cb = 0, cc = 0, cd = 1;
+            if(flags & 8) { ca = cd = s16(p) / 16384.0f; p += 2; }
+            else if(flags & 0x40) { ca = s16(p) / 16384.0f; cd = s16(p + 2) / 16384.0f; p += 4; }
+            else if(flags & 0x80) {
+                ca = s16(p) / 16384.0f; cb = s16(p + 2) / 16384.0f;
+                cc = s16(p + 4) / 16384.0f; cd = s16(p + 6) / 16384.0f;
+                p += 8;
+            }
+            glyphContours(component, a * ca + c * cb, b * ca + d * cb, a * cc + c * cd, b * cc + d * cd,
+                          a * ox + c * oy + dx, b * ox + d * oy + dy, contours, depth + 1);
+            if(!(flags & 0x20)) break;
+        }
+    }
+
+    // Signed-area accumulation buffer: each edge adds the area it covers to
+    // the right of itself, so a running sum along a row is the coverage
+    struct Accumulator {
+        int width, height, stride;
+        std::vector<float> cells;
+
+        Accumulator(int w, int h) : width(w), height(h), stride(w + 2), cells((size_t)(w + 2) * h, 0.0f) {}
+
+        void line(Point p0, Point p1) {
+            if(p0.y == p1.y) return;
+            float dir = 1;
+            if(p0.y > p1.y) {
+                std::swap(p0, p1);
+                dir = -1;
+            }
+            float dxdy = (p1.x - p0.x) / (p1.y - p0.y), x = p0.x;
+            if(p0.y < 0) x -= p0.y * dxdy;
+            int y_end = std::min(height, (int)std::ceil(p1.y));
+            for(int y = std::max(0, (int)p0.y); y < y_end; y++) {
+                float *row = cells.data() + (size_t)y * stride;
+                float dy = std::min((float)y + 1, p1.y) - std::max((float)y, p0.y);
+                float x_next = x + dxdy * dy, d = dy * dir;
+                float x0 = std::min(x, x_next), x1 = std::max(x, x_next);
+                x0 = std::max(0.0f, x0);
+                x1 = std::min((float)width, x1);
+                float x0_floor = std::floor(x0), x1_ceil = std::ceil(x1);
+                int x0i = (int)x0_floor, x1i = (int)x1_ceil;
+                if(x1i <= x0i + 1) {
+                    float middle = 0.5f * (x + x_next) - x0_floor;
+                    row[x0i] += d - d * middle;
+                    row[x0i + 1] += d * middle;
+                } else {
+                    float s = 1.0f / (x1 - x0), x0f = x0 - x0_floor, x1f = x1 - x1_ceil + 1.0f;
+                    float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f), am = 0.5f * s * x1f * x1f;
+                    row[x0i] += d * a0;
+                    if(x1i == x0i + 2) {
+                        row[x0i + 1] += d * (1.0f - a0 - am);
+                    } else {
+                        float a1 = s * (1.5f - x0f);
+                        row[x0i + 1] += d * (a1 - a0);
+                        for(int xi = x0i + 2; xi < x1i - 1; xi++) row[xi] += d * s;
+                        float a2 = a1 + (x1i - x0i - 3) * s;
+                        row[x1i - 1] += d * (1.0f - a2 - am);
+                    }
+                    row[x1i] += d * am;
+                }
+                x = x_next;
+            }
+        }
+
+        void quad(Point p0, Point p1, Point p2) {
+            float ddx = p0.x - 2 * p1.x + p2.x, ddy = p0.y - 2 * p1.y + p2.y;
+            float deviation = ddx * ddx + ddy * ddy;
+            int steps = deviation < 0.333f ? 1 : 1 + (int)std::sqrt(std::sqrt(3.0f * deviation));
+            Point from = p0;
+            for(int i = 1; i <= steps; i++) {
+                float t = (float)i / steps, u = 1 - t;
+                Point to{u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x, u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y,
+                         true};
+                line(from, to);
+                from = to;
+            }
+        }
+
+        std::vector<uint8_t> coverage() const {
+            std::vector<uint8_t> out((size_t)width * height);
+            for(int y = 0; y < height; y++) {
+                float sum = 0;
+                for(int x = 0; x < width; x++) {
+                    sum += cells[(size_t)y * stride + x];
+                    out[(size_t)y * width + x] = (uint8_t)(std::min(1.0f, std::fabs(sum)) * 255.0f + 0.5f);
+                }
+            }
+            return out;
+        }
+    };
+
+    // Trace one closed contour of on- and off-curve points; two off-curve
+    // points in a row imply an on-curve point halfway between them
+    static void walkContour(const std::vector<Point> &points, Accumulator &acc) {
+        size_t n = points.size(), first = 0;
+        auto midpoint = [](const Point &a, const Point &b) { return Point{(a.x + b.x) / 2, (a.y + b.y) / 2, true}; };
+        while(first < n && !points[first].on_curve) first++;
+        // Start on an on-curve point, or between the last and first points
+        // when there is none; then visit the other points in order
+        Point start;
+        std::vector<Point> sequence;
+        if(first < n) {
+            start = points[first];
+            for(size_t k = 1; k < n; k++) sequence.push_back(points[(first + k) % n]);
+        } else {
+            start = midpoint(points[n - 1], points[0]);
+            sequence = points;
+        }
+        Point current = start, control{0, 0, false};
+        bool has_control = false;
+        for(const Point &p : sequence) {
+            if(p.on_curve) {
+                if(has_control) acc.quad(current, control, p);
+                else acc.line(current, p);
+                current = p;
+                has_control = false;
+            } else {
+                if(has_control) {
+                    Point middle = midpoint(control, p);
+                    acc.quad(current, control, middle);
+                    current = middle;
+                }
+                control = p;
+                has_control = true;
+            }
+        }
+        if(has_control) acc.quad(current, control, start);
+        else acc.line(current, start);
+    }
+};
+
+#endif
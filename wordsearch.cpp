@@ -3,241 +3,693 @@
 WORD SEARCH PUZZLE GENERATOR
 ---------------------------------------------------------------------
 Generates a word search grid that maximizes overlap between words.
+Command-line front end over libwordsearch.
 =====================================================================
 */
 
+#include "libwordsearch.h"
+#include "minijson.h"
+#include "thread_pool.h"
+#include "json_writer.h"
+#include "binary_format.h"
+#include "dictionary.h"
+#include "result_cache.h"
+#include "puzzle_render.h"
+
 #include <iostream>
 #include <vector>
 #include <string>
 #include <algorithm>
-#include <random>
-#include <ctime>
-#include <set>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <functional>
+#include <thread>
+#include <stdexcept>
+#include <fstream>
+#include <iterator>
 #include <chrono>
+#include <random>
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 using namespace std;
+using namespace wordsearch;
 
 /*---------------------------------------------------------------
-  GLOBAL VARIABLES & CONSTANTS
+  INPUT HELPERS
 ---------------------------------------------------------------*/
-int GRID_ROWS = 0, GRID_COLS = 0;
-int MAX_RUNTIME_MS = 2000;
-chrono::steady_clock::time_point solver_start_time;
 
-// All 8 directions (horizontal, vertical, diagonal)
-static const vector<pair<int,int>> DIRECTIONS = {
-    {0,1}, {0,-1}, {1,0}, {-1,0}, {1,1}, {1,-1}, {-1,1}, {-1,-1}
-};
+// Apply a solver option shared by all modes; false if arg is not one
+bool applySolverFlag(const string &arg, SolverConfig &config) {
+    if(arg.rfind("--timems=", 0) == 0) config.runtime_ms = stoi(arg.substr(9));
+    else if(arg.rfind("--engine=", 0) == 0) {
+        string engine = arg.substr(9);
+        if(engine == "inplace") config.engine = ENGINE_INPLACE;
+        else if(engine == "copy") config.engine = ENGINE_COPY;
+        else if(engine == "bitboard") config.engine = ENGINE_BITBOARD;
+        else if(engine == "lns") config.engine = ENGINE_LNS;
+        else throw invalid_argument("Unknown engine: " + engine + " (expected inplace, copy, bitboard or lns)");
+    }
+    else if(arg.rfind("--threads=", 0) == 0) config.threads = stoi(arg.substr(10));
+    else if(arg == "--parallel=portfolio") config.parallel = PARALLEL_PORTFOLIO;
+    else if(arg == "--parallel=subtree") config.parallel = PARALLEL_SUBTREE;
+    else if(arg.rfind("--split-depth=", 0) == 0) config.split_depth = stoi(arg.substr(14));
+    else if(arg.rfind("--tt-bits=", 0) == 0) config.transposition_bits = stoi(arg.substr(10));
+    else if(arg.rfind("--node-budget=", 0) == 0) config.node_budget = stoll(arg.substr(14));
+    else if(arg.rfind("--order=", 0) == 0) {
+        string ordering = arg.substr(8);
+        if(ordering == "length") config.ordering = ORDER_LENGTH;
+        else if(ordering == "isolated") config.ordering = ORDER_ISOLATED;
+        else if(ordering == "dynamic") config.ordering = ORDER_DYNAMIC;
+        else if(ordering == "mixed") config.ordering = ORDER_MIXED;
+        else throw invalid_argument("Unknown word order: " + ordering +
+                                    " (expected length, isolated, dynamic or mixed)");
+    }
+    else if(arg == "--warm-mode=fixed") config.warm_start = WARM_START_FIXED;
+    else if(arg == "--warm-mode=incumbent") config.warm_start = WARM_START_INCUMBENT;
+    else if(arg == "--simd=off") config.use_simd = false;
+    else if(arg == "--simd=auto") config.use_simd = true;
+    else return false;
+    return true;
+}
+
+// Add one input word; a leading * marks it must-include
+void addInputWord(const string &raw, vector<string> &words, vector<bool> &required_flags) {
+    bool required = false;
+    string s = raw;
+    if(!s.empty() && s[0] == '*') { required = true; s = s.substr(1); }
+    string normalized = normalizeWord(s);
+    if(normalized.empty()) return;
+    words.push_back(normalized);
+    required_flags.push_back(required);
+}
+
+// Default square grid when no size is given: room for the letters, the
+// longest word and at least 10x10
+int estimateGridSize(const vector<string> &words) {
+    int total_letters = 0, max_word_len = 0;
+    for(auto &w : words) {
+        total_letters += (int)w.size();
+        max_word_len = max(max_word_len, (int)w.size());
+    }
+    int estimated = max(max_word_len, (int)ceil(sqrt((double)total_letters)) + 2);
+    return max(estimated, 10);
+}
+
+// Limits on what one server or batch request may ask for
+const int REQUEST_MAX_SIDE = 512;
+const int REQUEST_MAX_TIMEMS = 3600 * 1000;
+const int REQUEST_MAX_THREADS = 1024;    // then clamped to the CPU count
+
+// Integer value of a request field within [lo, hi]; throws otherwise, since
+// casting an out-of-range double to int is undefined
+int requestInt(const JsonValue &v, const string &what, int lo, int hi) {
+    if(v.type != JsonValue::JSON_NUMBER || v.number != floor(v.number) || v.number < lo || v.number > hi)
+        throw runtime_error(what + " must be an integer from " + to_string(lo) + " to " + to_string(hi));
+    return (int)v.number;
+}
+
+// Warm start from a previous result as this program writes it ({"rows",
+// "cols", "placements": [{"word", "row", "col", "dr", "dc"}, ...]}): its
+// placements mapped onto words by text. When rows and cols are unset the
+// grid keeps the previous size, grown to the estimate for the new words if
+// that is larger (placements that no longer fit are dropped by the solve).
+// Throws on a malformed result
+vector<WordPlacement> previousPlacements(const JsonValue &previous, const vector<string> &words, int &rows,
+                                         int &cols) {
+    const JsonValue *placements = previous.find("placements");
+    if(!placements || placements->type != JsonValue::JSON_ARRAY)
+        throw runtime_error("previous result has no \"placements\" array");
+    auto number = [](const JsonValue &object, const char *key) {
+        const JsonValue *v = object.find(key);
+        if(!v) throw runtime_error(string("previous placement needs a numeric \"") + key + "\"");
+        return requestInt(*v, string("previous \"") + key + "\"", -REQUEST_MAX_SIDE, REQUEST_MAX_SIDE);
+    };
+    vector<string> old_words;
+    vector<WordPlacement> old_placements;
+    for(auto &item : placements->items) {
+        const JsonValue *word = item.find("word");
+        if(!word || word->type != JsonValue::JSON_STRING) throw runtime_error("previous placement needs a \"word\"");
+        old_placements.push_back({(int)old_words.size(), number(item, "row"), number(item, "col"), number(item, "dr"),
+                                  number(item, "dc")});
+        old_words.push_back(normalizeWord(word->text));
+    }
+    if((rows <= 0 || cols <= 0) && previous.find("rows") && previous.find("cols")) {
+        int estimated = estimateGridSize(words);
+        rows = max(number(previous, "rows"), estimated);
+        cols = max(number(previous, "cols"), estimated);
+    }
+    return carryOverPlacements(old_words, old_placements, words);
+}
 
 /*---------------------------------------------------------------
-  DATA STRUCTURES
+  OUTPUT FORMATTING
 ---------------------------------------------------------------*/
-struct WordPlacement {
-    string word;
-    int row, col;
-    int delta_row, delta_col;
-};
 
-struct PuzzleResult {
-    vector<string> grid;
-    vector<WordPlacement> placements;
-    vector<string> placed_words;
-    vector<string> unplaced_words;
-    int num_placed = 0;
-    int total_overlap_score = 0;
+// Pretty is the classic multi-line CLI output; single-line is one NDJSON
+// record; compact additionally drops all optional whitespace
+enum JsonLayout { JSON_PRETTY, JSON_SINGLE_LINE, JSON_COMPACT };
+
+// How results are emitted: JSON in the given layout, or binary records
+// (--format=bin, see binary_format.h)
+struct OutputStyle {
+    JsonLayout layout = JSON_PRETTY;
+    bool binary = false;
+    bool stats = false;   // append the solver telemetry block to JSON results
+    bool progress = false; // stream best-so-far JSON records while solving (--progress)
 };
 
-/*---------------------------------------------------------------
-  HELPER FUNCTIONS
----------------------------------------------------------------*/
+// "stats": {...} for a result's telemetry, without a trailing comma
+void writeStatsJson(JsonWriter &out, const SolverStats &stats, bool spaced) {
+    out.key("stats", spaced);
+    out.raw("{\"nodes\":"); out.integer(stats.nodes);
+    out.raw(",\"candidates_generated\":"); out.integer(stats.candidates_generated);
+    out.raw(",\"candidates_explored\":"); out.integer(stats.candidates_explored);
+    out.raw(",\"prunes\":{\"count\":"); out.integer(stats.prunes_count);
+    out.raw(",\"required\":"); out.integer(stats.prunes_required);
+    out.raw(",\"overlap\":"); out.integer(stats.prunes_overlap);
+    out.raw(",\"transposition\":"); out.integer(stats.prunes_transposition);
+    out.raw("},\"timeouts\":"); out.integer(stats.timeouts);
+    out.raw(",\"peak_depth\":"); out.integer(stats.peak_depth);
+    out.raw(",\"improvements\":[");
+    for(size_t i = 0; i < stats.improvements.size(); i++) {
+        auto &step = stats.improvements[i];
+        if(i) out.raw(',');
+        out.raw("{\"us\":"); out.integer(step.elapsed_us);
+        out.raw(",\"worker\":"); out.integer(step.worker);
+        out.raw(",\"required\":"); out.integer(step.required);
+        out.raw(",\"placed\":"); out.integer(step.placed);
+        out.raw(",\"overlap\":"); out.integer(step.overlap);
+        out.raw('}');
+    }
+    out.raw("]}");
+}
 
-// Convert string to uppercase alphabetic only
-string normalizeWord(const string &input) {
-    string clean;
-    for(char ch : input)
-        if(isalpha((unsigned char)ch))
-            clean.push_back(toupper((unsigned char)ch));
-    return clean;
+// Append a result for the given word list to out; leading_fields (e.g.
+// "\"id\":7,") come first inside the object
+void writeResultJson(JsonWriter &out, const PuzzleResult &result, const vector<string> &words, JsonLayout layout,
+                     const string &leading_fields = "", bool with_stats = false) {
+    bool newlines = layout == JSON_PRETTY, spaced = layout != JSON_COMPACT;
+    int rows = result.grid.rows, cols = result.grid.cols;
+    size_t entries = result.placements.size() + result.placed_words.size() + result.unplaced_words.size();
+    out.reserve(out.buffer.size() + rows * (cols + 4) + entries * 64 + 256);
+    auto nl = [&]() { if(newlines) out.raw('\n'); };
+    auto wordArray = [&](const vector<string> &list) {
+        out.raw('[');
+        for(size_t i = 0; i < list.size(); ++i) {
+            if(i) out.raw(',');
+            out.string(list[i]);
+        }
+        out.raw(']');
+    };
+
+    out.raw('{'); nl();
+    out.raw(leading_fields);
+    out.key("rows", spaced); out.integer(rows); out.raw(','); nl();
+    out.key("cols", spaced); out.integer(cols); out.raw(','); nl();
+    out.key("grid", spaced); out.raw('['); nl();
+    for(int r = 0; r < rows; r++) {
+        out.raw('"');
+        out.buffer.append(result.grid.cells.data() + result.grid.index(r, 0), cols);
+        out.raw('"');
+        if(r + 1 < rows) out.raw(',');
+        nl();
+    }
+    out.raw("],"); nl();
+    out.key("placements", spaced); out.raw('['); nl();
+    for(size_t i = 0; i < result.placements.size(); ++i) {
+        auto &p = result.placements[i];
+        out.raw("{\"word\":"); out.string(words[p.word_index]);
+        out.raw(",\"row\":"); out.integer(p.row);
+        out.raw(",\"col\":"); out.integer(p.col);
+        out.raw(",\"dr\":"); out.integer(p.delta_row);
+        out.raw(",\"dc\":"); out.integer(p.delta_col);
+        out.raw('}');
+        if(i + 1 < result.placements.size()) out.raw(',');
+        nl();
+    }
+    out.raw("],"); nl();
+    out.key("placed_words", spaced); wordArray(result.placed_words); out.raw(','); nl();
+    out.key("unplaced_words", spaced); wordArray(result.unplaced_words);
+    if(with_stats) {
+        out.raw(','); nl();
+        writeStatsJson(out, result.stats, spaced);
+    }
+    nl();
+    out.raw('}'); nl();
 }
 
-// Check if a cell is within grid boundaries
-bool isInBounds(int r, int c) {
-    return r >= 0 && r < GRID_ROWS && c >= 0 && c < GRID_COLS;
+// One --progress record, with its line terminator: a best-so-far layout
+// (cells no word passes through are still '.') marked "progress": true and
+// stamped with the milliseconds since its solve started
+void writeProgressJson(JsonWriter &out, const PuzzleResult &result, const vector<string> &words, JsonLayout layout,
+                       const string &id_field, long long elapsed_ms) {
+    writeResultJson(out, result, words, layout == JSON_COMPACT ? JSON_COMPACT : JSON_SINGLE_LINE,
+                    id_field + "\"progress\":true,\"elapsed_ms\":" + to_string(elapsed_ms) + ",");
+    out.raw('\n');
 }
 
-// Check if solver exceeded runtime limit
-bool hasTimedOut() {
-    auto now = chrono::steady_clock::now();
-    int elapsed_ms = chrono::duration_cast<chrono::milliseconds>(now - solver_start_time).count();
-    return elapsed_ms >= MAX_RUNTIME_MS;
+// Make a solve with config send each progress record to sink; words must
+// outlive the solve
+void attachProgress(SolverConfig &config, const vector<string> &words, JsonLayout layout, const string &id_field,
+                    function<void(const string &)> sink) {
+    auto start = chrono::steady_clock::now();
+    config.progress = [&words, layout, id_field, sink, start](const PuzzleResult &best) {
+        long long elapsed_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        JsonWriter out;
+        writeProgressJson(out, best, words, layout, id_field, elapsed_ms);
+        sink(out.buffer);
+    };
 }
 
 /*---------------------------------------------------------------
-  GRID VALIDATION & PLACEMENT
+  PUZZLE REQUESTS
 ---------------------------------------------------------------*/
 
-// Validate word placement and count overlaps
-bool canPlaceWord(const vector<string>& grid, const string &word, int r, int c, int dr, int dc, int &overlap_count) {
-    overlap_count = 0;
-    for(char ch : word) {
-        if(!isInBounds(r, c)) return false;
-        char existing = grid[r][c];
-        if(existing != '.' && existing != ch) return false;
-        if(existing == ch) overlap_count++;
-        r += dr; c += dc;
+// One puzzle to solve in server or batch mode
+struct PuzzleRequest {
+    string id_field;          // "\"id\":...," echoed into the reply, or empty
+    string id;                // the id as plain text, for binary replies
+    vector<string> words;
+    vector<bool> required_flags;
+    SolverConfig config;
+    bool has_timems = false;  // the request set its own time limit
+    vector<WordPlacement> previous;   // warm start from the request's "previous" result
+    bool progress = false;    // stream progress records before the reply (server mode)
+};
+
+// Fill request from one JSON object: {"id", "words", "required", "rows",
+// "cols", "timems", "threads", "previous", "warm_mode", "progress"}; only "words" is
+// mandatory. "previous" is an earlier reply to warm-start from. Throws on
+// bad input, after id_field is set when the id could be read
+void parsePuzzleRequest(const string &line, PuzzleRequest &request) {
+    JsonValue json = parseJson(line);
+    if(json.type != JsonValue::JSON_OBJECT) throw runtime_error("request must be a JSON object");
+    if(const JsonValue *id = json.find("id")) {
+        if(id->type != JsonValue::JSON_STRING && id->type != JsonValue::JSON_NUMBER)
+            throw runtime_error("\"id\" must be a string or number");
+        request.id_field = "\"id\":" + (id->type == JsonValue::JSON_STRING ? jsonQuote(id->text) : id->text) + ",";
+        request.id = id->text;
+    }
+
+    const JsonValue *word_list = json.find("words");
+    if(!word_list || word_list->type != JsonValue::JSON_ARRAY) throw runtime_error("\"words\" must be an array");
+    const JsonValue *required = json.find("required");
+    for(size_t i = 0; i < word_list->items.size(); i++) {
+        if(word_list->items[i].type != JsonValue::JSON_STRING) throw runtime_error("words must be strings");
+        string raw = word_list->items[i].text;
+        bool flagged = required && required->type == JsonValue::JSON_ARRAY && i < required->items.size() &&
+                       required->items[i].boolean;
+        addInputWord(flagged ? "*" + raw : raw, request.words, request.required_flags);
     }
+
+    auto intField = [&](const char *key, int &target, int lo, int hi) {
+        const JsonValue *v = json.find(key);
+        if(!v) return false;
+        target = requestInt(*v, string("\"") + key + "\"", lo, hi);
+        return true;
+    };
+    intField("rows", request.config.rows, 0, REQUEST_MAX_SIDE);
+    intField("cols", request.config.cols, 0, REQUEST_MAX_SIDE);
+    if(intField("timems", request.config.runtime_ms, 0, REQUEST_MAX_TIMEMS)) request.has_timems = true;
+    if(intField("threads", request.config.threads, 1, REQUEST_MAX_THREADS))
+        request.config.threads = min(request.config.threads, max(1, (int)thread::hardware_concurrency()));
+    // An unset size is estimated from the words, so they are capped too
+    if((request.config.rows <= 0 || request.config.cols <= 0) && estimateGridSize(request.words) > REQUEST_MAX_SIDE)
+        throw runtime_error("words need a grid larger than " + to_string(REQUEST_MAX_SIDE) + "x" +
+                            to_string(REQUEST_MAX_SIDE));
+
+    if(const JsonValue *previous = json.find("previous")) {
+        if(previous->type != JsonValue::JSON_OBJECT) throw runtime_error("\"previous\" must be a result object");
+        request.previous = previousPlacements(*previous, request.words, request.config.rows, request.config.cols);
+    }
+
+    if(const JsonValue *mode = json.find("warm_mode")) {
+        if(mode->type == JsonValue::JSON_STRING && mode->text == "fixed") request.config.warm_start = WARM_START_FIXED;
+        else if(mode->type == JsonValue::JSON_STRING && mode->text == "incumbent")
+            request.config.warm_start = WARM_START_INCUMBENT;
+        else throw runtime_error("\"warm_mode\" must be \"fixed\" or \"incumbent\"");
+    }
+    if(const JsonValue *progress = json.find("progress")) {
+        if(progress->type != JsonValue::JSON_BOOL) throw runtime_error("\"progress\" must be true or false");
+        request.progress = progress->boolean;
+    }
+}
+
+// Whether line is a {"cancel": id} command rather than a puzzle, and the id
+// it names; throws on a malformed one
+bool parseCancelRequest(const string &line, string &id) {
+    if(line.find("\"cancel\"") == string::npos) return false;
+    JsonValue json = parseJson(line);
+    const JsonValue *target = json.type == JsonValue::JSON_OBJECT ? json.find("cancel") : nullptr;
+    if(!target || json.find("words")) return false;
+    if(target->type != JsonValue::JSON_STRING && target->type != JsonValue::JSON_NUMBER)
+        throw runtime_error("\"cancel\" must be a request id");
+    id = target->text;
     return true;
 }
 
-// Write word into grid
-void placeWord(vector<string>& grid, const string &word, int r, int c, int dr, int dc) {
-    for(char ch : word) {
-        grid[r][c] = ch;
-        r += dr; c += dc;
+// Solve a parsed request and append its reply (one JSON line or one binary
+// record, without the line terminator) to out. With a cache, hits skip the
+// solver (JSON replies then carry "cached": true and no "stats" block, as
+// nothing was searched) and misses are stored.
+// solver, when given, is the one to solve with, so it can be cancelled from
+// elsewhere; a cancelled solve replies with its best so far and
+// "cancelled": true, and is not cached
+void solvePuzzleRequest(PuzzleRequest &request, const OutputStyle &style, ResultCache *cache, JsonWriter &out,
+                        Solver *solver = nullptr) {
+    if(request.words.empty()) throw runtime_error("No valid words found after normalization.");
+    SolverConfig &config = request.config;
+    if(config.rows <= 0 || config.cols <= 0) config.rows = config.cols = estimateGridSize(request.words);
+
+    PuzzleResult result;
+    string cache_key;
+    ResultCache::Entry entry;
+    bool hit = false;
+    // A layout carried in the request shapes the result but is not keyed
+    if(!request.previous.empty()) cache = nullptr;
+    if(cache) {
+        // Warm hits get the request's own budget on top, so any entry helps
+        cache_key = ResultCache::key(request.words, request.required_flags, config);
+        hit = cache->find(cache_key, cache->warm ? 0 : ResultCache::budgetOf(config), entry);
     }
+    bool served = hit && !cache->warm;
+    if(served) {
+        result = ResultCache::toResult(entry, request.words, cache->refill, config.seed);
+    } else {
+        // A warm cache hit becomes the incumbent of a fresh solve
+        vector<WordPlacement> previous = request.previous;
+        if(hit) {
+            previous = ResultCache::placementsFor(entry, request.words);
+            config.warm_start = WARM_START_INCUMBENT;
+        }
+        Solver local_solver;
+        Solver &active = solver ? *solver : local_solver;
+        active.config = config;
+        result = active.solve(request.words, request.required_flags, previous);
+        if(cache && !result.cancelled) {
+            // A warm solve is at least as good as the entry it started from
+            long long budget = max(ResultCache::budgetOf(config), hit ? entry.budget : 0LL);
+            cache->insert(cache_key, ResultCache::fromResult(result, request.words, budget));
+        }
+    }
+
+    string marks = string(hit ? "\"cached\":true," : "") + (result.cancelled ? "\"cancelled\":true," : "");
+    if(style.binary) appendBinaryResult(out.buffer, result, request.words, request.id);
+    else writeResultJson(out, result, request.words, style.layout == JSON_PRETTY ? JSON_SINGLE_LINE : style.layout,
+                         request.id_field + marks, style.stats && !served);
+}
+
+void writeErrorReply(JsonWriter &out, const PuzzleRequest &request, const string &message, const OutputStyle &style) {
+    if(style.binary) {
+        appendBinaryError(out.buffer, message, request.id);
+        return;
+    }
+    out.raw('{');
+    out.raw(request.id_field);
+    out.raw("\"error\":");
+    out.string(message);
+    out.raw('}');
 }
 
 /*---------------------------------------------------------------
-  OVERLAP SCORING
+  SERVER MODE
 ---------------------------------------------------------------*/
 
-// Compute total overlap score for all placed words
-int calculateOverlapScore(const vector<WordPlacement>& placements) {
-    if(placements.empty()) return 0;
-    vector<vector<int>> overlap_map(GRID_ROWS, vector<int>(GRID_COLS, 0));
+#ifndef _WIN32
+// A parsed request waiting for or running on the pool, with the solver it
+// will run on so that it can be cancelled at any point
+struct ServeJob {
+    PuzzleRequest request;
+    Solver solver;
+};
+
+// Response side of one request stream; the fd is closed (for sockets) once
+// the last in-flight request holding the stream has answered
+struct ServeStream {
+    int fd;
+    bool owns_fd;
+    mutex write_lock;
+
+    // This stream's queued and running requests that have an id, for
+    // {"cancel": id} lines (which only reach the sender's own requests)
+    mutex jobs_lock;
+    multimap<string, ServeJob *> jobs;
+
+    ServeStream(int out_fd, bool owns) : fd(out_fd), owns_fd(owns) {}
+    ~ServeStream() { if(owns_fd) close(fd); }
+
+    void track(ServeJob *job) {
+        lock_guard<mutex> guard(jobs_lock);
+        jobs.emplace(job->request.id, job);
+    }
+
+    void untrack(ServeJob *job) {
+        lock_guard<mutex> guard(jobs_lock);
+        auto range = jobs.equal_range(job->request.id);
+        for(auto it = range.first; it != range.second; ++it)
+            if(it->second == job) { jobs.erase(it); return; }
+    }
+
+    // Stop every request with this id; a queued one answers as soon as it starts
+    void cancel(const string &id) {
+        lock_guard<mutex> guard(jobs_lock);
+        auto range = jobs.equal_range(id);
+        for(auto it = range.first; it != range.second; ++it) it->second->solver.cancel();
+    }
 
-    for(const auto &p : placements) {
-        int rr = p.row, cc = p.col;
-        for(char ch : p.word) {
-            if(isInBounds(rr, cc)) overlap_map[rr][cc]++;
-            rr += p.delta_row; cc += p.delta_col;
+    void writeAll(const string &line) {
+        lock_guard<mutex> guard(write_lock);
+        size_t done = 0;
+        while(done < line.size()) {
+            ssize_t n = write(fd, line.data() + done, line.size() - done);
+            if(n <= 0) return;
+            done += n;
         }
     }
+};
 
-    int overlap_score = 0;
-    for(int r = 0; r < GRID_ROWS; r++)
-        for(int c = 0; c < GRID_COLS; c++)
-            if(overlap_map[r][c] > 1)
-                overlap_score += (overlap_map[r][c] - 1);
-    return overlap_score;
+// Solve one queued request into out, streaming its progress records to
+// the stream first when asked; errors become {"id", "error"} records
+// instead of ending the server
+void answerServeJob(ServeJob &job, shared_ptr<ServeStream> stream, const OutputStyle &style, ResultCache *cache,
+                    JsonWriter &out) {
+    PuzzleRequest &request = job.request;
+    if(request.progress && !style.binary)
+        attachProgress(request.config, request.words, style.layout, request.id_field,
+                       [stream](const string &line) { stream->writeAll(line); });
+    try {
+        solvePuzzleRequest(request, style, cache, out, &job.solver);
+    } catch(const exception &e) {
+        out.clear();
+        writeErrorReply(out, request, e.what(), style);
+    }
+    if(!style.binary) out.raw('\n');
 }
 
-/*---------------------------------------------------------------
-  RECURSIVE BACKTRACKING ALGORITHM
----------------------------------------------------------------*/
-void solvePuzzleRecursively(const vector<string>& words,
-                            const vector<int>& word_order,
-                            int current_index,
-                            vector<string>& grid,
-                            vector<WordPlacement>& current_placements,
-                            vector<bool>& used_flags,
-                            PuzzleResult &best_result) {
-
-    if(hasTimedOut()) return;
-
-    int placed_count = current_placements.size();
-    int current_overlap = calculateOverlapScore(current_placements);
-
-    // Update best solution
-    if(placed_count > best_result.num_placed || 
-       (placed_count == best_result.num_placed && current_overlap > best_result.total_overlap_score)) {
-        best_result.num_placed = placed_count;
-        best_result.total_overlap_score = current_overlap;
-        best_result.grid = grid;
-        best_result.placements = current_placements;
-    }
-
-    if(current_index >= (int)word_order.size()) return;
-
-    // Stop if no chance to improve best
-    int remaining = word_order.size() - current_index;
-    if(placed_count + remaining <= best_result.num_placed) return;
-
-    int word_index = word_order[current_index];
-    const string &current_word = words[word_index];
-
-    struct Candidate { int r, c, dr, dc, overlap; };
-    vector<Candidate> candidates;
-
-    // Generate valid placement options
-    for(int r = 0; r < GRID_ROWS; r++)
-        for(int c = 0; c < GRID_COLS; c++)
-            for(auto dir : DIRECTIONS) {
-                int overlap_val;
-                if(canPlaceWord(grid, current_word, r, c, dir.first, dir.second, overlap_val))
-                    candidates.push_back({r, c, dir.first, dir.second, overlap_val});
+// Read newline-delimited requests from fd until EOF. Each is parsed here
+// and queued on the pool (malformed ones are answered at once), while
+// {"cancel": id} lines take effect immediately
+void serveRequests(int in_fd, shared_ptr<ServeStream> stream, ThreadPool &pool, const SolverConfig &config,
+                   const OutputStyle &style, ResultCache *cache) {
+    string buffer;
+    char chunk[65536];
+    auto dispatch = [&](string line) {
+        if(line.find_first_not_of(" \t\r") == string::npos) return;
+        auto job = make_shared<ServeJob>();
+        job->request.config = config;
+        job->request.progress = style.progress;
+        try {
+            string cancel_id;
+            if(parseCancelRequest(line, cancel_id)) {
+                stream->cancel(cancel_id);
+                return;
             }
+            parsePuzzleRequest(line, job->request);
+        } catch(const exception &e) {
+            JsonWriter writer;
+            writeErrorReply(writer, job->request, e.what(), style);
+            if(!style.binary) writer.raw('\n');
+            stream->writeAll(writer.buffer);
+            return;
+        }
+        bool tracked = !job->request.id_field.empty();
+        if(tracked) stream->track(job.get());
+        pool.submit([job, stream, style, cache, tracked]() {
+            // Each pool thread formats into its own reusable buffer
+            thread_local JsonWriter writer;
+            writer.clear();
+            answerServeJob(*job, stream, style, cache, writer);
+            if(tracked) stream->untrack(job.get());
+            stream->writeAll(writer.buffer);
+        });
+    };
+    for(;;) {
+        ssize_t n = read(in_fd, chunk, sizeof(chunk));
+        if(n <= 0) break;
+        buffer.append(chunk, n);
+        size_t start = 0, newline;
+        while((newline = buffer.find('\n', start)) != string::npos) {
+            dispatch(buffer.substr(start, newline - start));
+            start = newline + 1;
+        }
+        buffer.erase(0, start);
+    }
+    dispatch(buffer);
+}
 
-    // Sort by overlap and centrality
-    sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
-        if(a.overlap != b.overlap) return a.overlap > b.overlap;
-        int dist_a = abs(a.r - GRID_ROWS/2) + abs(a.c - GRID_COLS/2);
-        int dist_b = abs(b.r - GRID_ROWS/2) + abs(b.c - GRID_COLS/2);
-        return dist_a < dist_b;
-    });
+// Resident mode: answer requests from stdin, or from every client of a Unix
+// socket when socket_path is set
+int runServer(const SolverConfig &config, const OutputStyle &style, ResultCache *cache, int worker_count,
+              const string &socket_path) {
+    signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(worker_count);
+    if(socket_path.empty()) {
+        serveRequests(0, make_shared<ServeStream>(1, false), pool, config, style, cache);
+        pool.wait();
+        return 0;
+    }
 
-    // Recursive placement attempts
-    for(const auto &cand : candidates) {
-        if(hasTimedOut()) return;
-        vector<string> new_grid = grid;
-        placeWord(new_grid, current_word, cand.r, cand.c, cand.dr, cand.dc);
-        current_placements.push_back({current_word, cand.r, cand.c, cand.dr, cand.dc});
-        used_flags[word_index] = true;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if(listener < 0 || socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Cannot create socket " << socket_path << "\n";
+        return 1;
+    }
+    socket_path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if(bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0) {
+        cerr << "Cannot listen on socket " << socket_path << "\n";
+        return 1;
+    }
+    for(;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if(client < 0) continue;
+        thread([client, &pool, &config, style, cache]() {
+            serveRequests(client, make_shared<ServeStream>(client, true), pool, config, style, cache);
+        }).detach();
+    }
+}
+#endif
 
-        solvePuzzleRecursively(words, word_order, current_index + 1, new_grid, current_placements, used_flags, best_result);
+/*---------------------------------------------------------------
+  BATCH MODE
+---------------------------------------------------------------*/
 
-        used_flags[word_index] = false;
-        current_placements.pop_back();
+// Split batch input into puzzles: JSONL requests when the first non-blank
+// character is '{', otherwise word lists separated by blank lines
+vector<PuzzleRequest> readBatchInput(istream &in, const SolverConfig &base_config, vector<string> &parse_errors) {
+    vector<PuzzleRequest> requests;
+    vector<string> lines;
+    string line;
+    while(getline(in, line)) lines.push_back(line);
+
+    bool jsonl = false;
+    for(auto &l : lines) {
+        size_t a = l.find_first_not_of(" \t\r");
+        if(a != string::npos) { jsonl = l[a] == '{'; break; }
     }
 
-    // Optionally skip this word
-    if(!hasTimedOut())
-        solvePuzzleRecursively(words, word_order, current_index + 1, grid, current_placements, used_flags, best_result);
+    bool in_list = false;
+    for(auto &l : lines) {
+        size_t a = l.find_first_not_of(" \t\r");
+        if(a == string::npos) { in_list = false; continue; }
+        size_t b = l.find_last_not_of(" \t\r");
+        string text = l.substr(a, b - a + 1);
+        if(jsonl) {
+            requests.emplace_back();
+            requests.back().config = base_config;
+            parse_errors.emplace_back();
+            try {
+                parsePuzzleRequest(text, requests.back());
+            } catch(const exception &e) {
+                parse_errors.back() = e.what();
+            }
+            continue;
+        }
+        if(!in_list) {
+            requests.emplace_back();
+            requests.back().config = base_config;
+            parse_errors.emplace_back();
+            in_list = true;
+        }
+        addInputWord(text, requests.back().words, requests.back().required_flags);
+    }
+    return requests;
 }
 
-/*---------------------------------------------------------------
-  PUZZLE SOLVER ENTRY FUNCTION
----------------------------------------------------------------*/
-PuzzleResult generateWordSearch(const vector<string>& words,
-                                const vector<bool>& required_flags,
-                                int rows, int cols, int runtime_ms) {
-    GRID_ROWS = rows;
-    GRID_COLS = cols;
-    MAX_RUNTIME_MS = runtime_ms;
-    solver_start_time = chrono::steady_clock::now();
-    vector<string> blank_grid(rows, string(cols, '.'));
-
-    // Determine optimal word order
-    vector<int> word_order;
-    for(int pass = 0; pass < 2; ++pass) {
-        vector<pair<int,int>> tmp;
-        for(int i = 0; i < (int)words.size(); ++i)
-            if((pass == 0) == required_flags[i])
-                tmp.push_back({(int)words[i].size(), i});
-        sort(tmp.begin(), tmp.end(), greater<>());
-        for(auto &p : tmp) word_order.push_back(p.second);
-    }
-
-    vector<bool> used_flags(words.size(), false);
-    vector<WordPlacement> current_placements;
-    PuzzleResult best_result;
-
-    solvePuzzleRecursively(words, word_order, 0, blank_grid, current_placements, used_flags, best_result);
-
-    // Identify which words were placed
-    set<string> placed_set;
-    for(auto &p : best_result.placements) placed_set.insert(p.word);
-    for(auto &w : words)
-        (placed_set.count(w) ? best_result.placed_words : best_result.unplaced_words).push_back(w);
-
-    // Fill remaining cells randomly
-    mt19937_64 rng((uint64_t)chrono::steady_clock::now().time_since_epoch().count());
-    uniform_int_distribution<int> dist(0, 25);
-    for(int r = 0; r < rows; r++)
-        for(int c = 0; c < cols; c++)
-            if(best_result.grid[r][c] == '.')
-                best_result.grid[r][c] = char('A' + dist(rng));
-
-    return best_result;
+// Solve every puzzle on a pool and write the replies in input order.
+// With total_ms > 0 each puzzle's budget is carved, when it starts, from the
+// wall time left in proportion to its share of the remaining letters
+// (capped by the per-puzzle --timems when one was given)
+int runBatch(istream &in, const SolverConfig &base_config, const OutputStyle &style, ResultCache *cache,
+             bool has_timems, int worker_count, int total_ms) {
+    vector<string> parse_errors;
+    vector<PuzzleRequest> requests = readBatchInput(in, base_config, parse_errors);
+    size_t count = requests.size();
+
+    vector<long long> weights(count);
+    long long unstarted_weight = 0;
+    for(size_t i = 0; i < count; i++) {
+        long long letters = 0;
+        for(auto &w : requests[i].words) letters += w.size();
+        weights[i] = max(1LL, letters);
+        unstarted_weight += weights[i];
+    }
+    size_t unstarted_count = count;
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(total_ms);
+
+    mutex lock;
+    vector<string> replies(count);
+    vector<bool> ready(count, false);
+    size_t next_output = 0;
+
+    ThreadPool pool(worker_count);
+    for(size_t i = 0; i < count; i++)
+        pool.submit([&, i]() {
+            PuzzleRequest &request = requests[i];
+            if(total_ms > 0) {
+                lock_guard<mutex> guard(lock);
+                long long left_ms = max(0LL, (long long)chrono::duration_cast<chrono::milliseconds>(
+                                                 deadline - chrono::steady_clock::now()).count());
+                long long lanes = min<long long>(worker_count, unstarted_count);
+                long long budget = min(left_ms, left_ms * lanes * weights[i] / max(1LL, unstarted_weight));
+                if(request.has_timems || has_timems) budget = min<long long>(budget, request.config.runtime_ms);
+                request.config.runtime_ms = (int)max(1LL, budget);
+                unstarted_weight -= weights[i];
+                unstarted_count--;
+            }
+
+            thread_local JsonWriter writer;
+            writer.clear();
+            try {
+                if(!parse_errors[i].empty()) throw runtime_error(parse_errors[i]);
+                solvePuzzleRequest(request, style, cache, writer);
+            } catch(const exception &e) {
+                writer.clear();
+                writeErrorReply(writer, request, e.what(), style);
+            }
+            if(!style.binary) writer.raw('\n');
+
+            // Emit every reply that is now contiguous with the output so far
+            lock_guard<mutex> guard(lock);
+            replies[i] = writer.buffer;
+            ready[i] = true;
+            while(next_output < count && ready[next_output]) {
+                fwrite(replies[next_output].data(), 1, replies[next_output].size(), stdout);
+                string().swap(replies[next_output]);
+                next_output++;
+            }
+            fflush(stdout);
+        });
+    pool.wait();
+    return 0;
 }
 
 /*---------------------------------------------------------------
@@ -247,41 +699,128 @@ int main(int argc, char** argv) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    SolverConfig config;
     int cli_rows = 0, cli_cols = 0;
+    bool serve = false, batch = false, has_timems = false, auto_size = false;
+    OutputStyle style;
+    RenderOptions render;
+    string socket_path, batch_path, dict_path, cache_path;
+    long long cache_entries = 0;
+    bool cache_refill = false, cache_warm = false;
+    string warm_path;
+    int total_ms = 0;
+    long long sample_count = 0;
+    uint64_t sample_seed = random_device()();
+    int worker_count = max(1, (int)thread::hardware_concurrency());
     for(int i = 1; i < argc; i++) {
         string arg = argv[i];
+        try {
+            if(arg.rfind("--timems=", 0) == 0) has_timems = true;
+            if(applySolverFlag(arg, config) || applyRenderFlag(arg, render)) continue;
+        } catch(const invalid_argument &e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
         if(arg.rfind("--rows=", 0) == 0) cli_rows = stoi(arg.substr(7));
         else if(arg.rfind("--cols=", 0) == 0) cli_cols = stoi(arg.substr(7));
-        else if(arg.rfind("--timems=", 0) == 0) MAX_RUNTIME_MS = stoi(arg.substr(9));
+        else if(arg == "--auto-size=min") auto_size = true;
+        else if(arg == "--serve") serve = true;
+        else if(arg == "--compact") style.layout = JSON_COMPACT;
+        else if(arg == "--stats") style.stats = true;
+        else if(arg == "--progress") style.progress = true;
+        else if(arg.rfind("--progress=", 0) == 0) {
+            style.progress = true;
+            config.progress_interval_ms = stoi(arg.substr(11));
+        }
+        else if(arg == "--format=json") style.binary = false;
+        else if(arg == "--format=bin") style.binary = true;
+        else if(arg.rfind("--socket=", 0) == 0) socket_path = arg.substr(9);
+        else if(arg.rfind("--workers=", 0) == 0) worker_count = stoi(arg.substr(10));
+        else if(arg == "--batch") batch = true;
+        else if(arg.rfind("--batch=", 0) == 0) { batch = true; batch_path = arg.substr(8); }
+        else if(arg.rfind("--total-ms=", 0) == 0) total_ms = stoi(arg.substr(11));
+        else if(arg.rfind("--dict=", 0) == 0) dict_path = arg.substr(7);
+        else if(arg.rfind("--cache=", 0) == 0) cache_entries = stoll(arg.substr(8));
+        else if(arg.rfind("--cache-file=", 0) == 0) cache_path = arg.substr(13);
+        else if(arg == "--cache-refill") cache_refill = true;
+        else if(arg == "--cache-warm") cache_warm = true;
+        else if(arg.rfind("--warm-start=", 0) == 0) warm_path = arg.substr(13);
+        else if(arg.rfind("--sample=", 0) == 0) sample_count = stoll(arg.substr(9));
+        else if(arg.rfind("--seed=", 0) == 0) sample_seed = config.seed = stoull(arg.substr(7));
     }
 
-    vector<string> input_lines;
-    string line;
-    while(getline(cin, line)) {
-        size_t a = line.find_first_not_of(" \t");
-        size_t b = line.find_last_not_of(" \t");
-        if(a == string::npos) continue;
-        input_lines.push_back(line.substr(a, b - a + 1));
+    if(render.enabled && (serve || batch)) {
+        cerr << "--render works on a single puzzle, not with --serve or --batch.\n";
+        return 1;
+    }
+    if(style.progress && style.binary) {
+        cerr << "--progress needs JSON output.\n";
+        return 1;
     }
 
-    if(input_lines.empty()) {
-        cerr << "Provide words via stdin (one per line). Prefix * for must-include words.\n";
+    // Server and batch replies may come from the result cache
+    unique_ptr<ResultCache> cache;
+    if((serve || batch) && (cache_entries > 0 || !cache_path.empty())) {
+        cache = make_unique<ResultCache>(cache_entries > 0 ? cache_entries : 1024);
+        cache->refill = cache_refill;
+        cache->warm = cache_warm;
+        if(!cache_path.empty() && !cache->open(cache_path)) {
+            cerr << "Cannot write cache file " << cache_path << "\n";
+            return 1;
+        }
+    }
+
+    if(serve) {
+#ifndef _WIN32
+        config.rows = cli_rows;
+        config.cols = cli_cols;
+        return runServer(config, style, cache.get(), worker_count, socket_path);
+#else
+        cerr << "--serve is not supported on this platform.\n";
         return 1;
+#endif
+    }
+
+    if(batch) {
+        config.rows = cli_rows;
+        config.cols = cli_cols;
+        if(batch_path.empty()) return runBatch(cin, config, style, cache.get(), has_timems, worker_count, total_ms);
+        ifstream batch_file(batch_path);
+        if(!batch_file) {
+            cerr << "Cannot open batch file " << batch_path << "\n";
+            return 1;
+        }
+        return runBatch(batch_file, config, style, cache.get(), has_timems, worker_count, total_ms);
     }
 
     vector<string> words;
     vector<bool> required_flags;
-    int max_word_len = 0;
+    if(!dict_path.empty()) {
+        // Only the sampled entries leave the dictionary arena as strings
+        WordDictionary dict;
+        if(!dict.load(dict_path)) {
+            cerr << "Cannot read dictionary " << dict_path << "\n";
+            return 1;
+        }
+        if(sample_count > 0)
+            for(size_t i : dict.sample(sample_count, sample_seed)) dict.take(i, words, required_flags);
+        else
+            for(size_t i = 0; i < dict.size(); i++) dict.take(i, words, required_flags);
+    } else {
+        vector<string> input_lines;
+        string line;
+        while(getline(cin, line)) {
+            size_t a = line.find_first_not_of(" \t");
+            size_t b = line.find_last_not_of(" \t");
+            if(a == string::npos) continue;
+            input_lines.push_back(line.substr(a, b - a + 1));
+        }
 
-    for(auto &raw : input_lines) {
-        bool required = false;
-        string s = raw;
-        if(!s.empty() && s[0] == '*') { required = true; s = s.substr(1); }
-        string normalized = normalizeWord(s);
-        if(normalized.empty()) continue;
-        words.push_back(normalized);
-        required_flags.push_back(required);
-        max_word_len = max(max_word_len, (int)normalized.size());
+        if(input_lines.empty()) {
+            cerr << "Provide words via stdin (one per line). Prefix * for must-include words.\n";
+            return 1;
+        }
+        for(auto &raw : input_lines) addInputWord(raw, words, required_flags);
     }
 
     if(words.empty()) {
@@ -289,37 +828,63 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    int rows = cli_rows, cols = cli_cols;
-    if(rows <= 0 || cols <= 0) {
-        int total_letters = 0;
-        for(auto &w : words) total_letters += (int)w.size();
-        int estimated = max(max_word_len, (int)ceil(sqrt((double)total_letters)) + 2);
-        rows = cols = max(estimated, 10);
+    // Warm start from a previous result file, at its size (or the estimate, if
+    // larger) unless one is given
+    vector<WordPlacement> previous;
+    if(!warm_path.empty()) {
+        if(auto_size) {
+            cerr << "--warm-start cannot be combined with --auto-size.\n";
+            return 1;
+        }
+        ifstream warm_file(warm_path);
+        string text((istreambuf_iterator<char>(warm_file)), istreambuf_iterator<char>());
+        try {
+            if(!warm_file) throw runtime_error("cannot read file");
+            previous = previousPlacements(parseJson(text), words, cli_rows, cli_cols);
+        } catch(const exception &e) {
+            cerr << "Bad --warm-start result " << warm_path << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // With --progress stdout is JSONL: progress records, then the result on one line
+    if(style.progress) {
+        if(style.layout == JSON_PRETTY) style.layout = JSON_SINGLE_LINE;
+        attachProgress(config, words, style.layout, "", [](const string &line) {
+            fwrite(line.data(), 1, line.size(), stdout);
+            fflush(stdout);
+        });
     }
 
-    PuzzleResult result = generateWordSearch(words, required_flags, rows, cols, MAX_RUNTIME_MS);
+    PuzzleResult result;
+    if(auto_size) {
+        // --rows/--cols, when both given, only set the aspect ratio
+        double aspect = cli_rows > 0 && cli_cols > 0 ? (double)cli_cols / cli_rows : 1.0;
+        result = solveSmallestGrid(config, words, required_flags, aspect);
+    } else {
+        int rows = cli_rows, cols = cli_cols;
+        if(rows <= 0 || cols <= 0) rows = cols = estimateGridSize(words);
+        config.rows = rows;
+        config.cols = cols;
+        Solver solver(config);
+        result = solver.solve(words, required_flags, previous);
+    }
 
-    // Output as JSON
-    cout << "{\n";
-    cout << "\"rows\": " << rows << ",\n";
-    cout << "\"cols\": " << cols << ",\n";
-    cout << "\"grid\": [\n";
-    for(int r = 0; r < rows; r++)
-        cout << "\"" << result.grid[r] << "\"" << (r + 1 < rows ? "," : "") << "\n";
-    cout << "],\n\"placements\": [\n";
-    for(size_t i = 0; i < result.placements.size(); ++i) {
-        auto &p = result.placements[i];
-        cout << "{\"word\":\"" << p.word << "\",\"row\":" << p.row
-             << ",\"col\":" << p.col << ",\"dr\":" << p.delta_row << ",\"dc\":" << p.delta_col << "}"
-             << (i + 1 < result.placements.size() ? "," : "") << "\n";
-    }
-    cout << "],\n\"placed_words\": [";
-    for(size_t i = 0; i < result.placed_words.size(); ++i)
-        cout << "\"" << result.placed_words[i] << "\"" << (i + 1 < result.placed_words.size() ? "," : "");
-    cout << "],\n\"unplaced_words\": [";
-    for(size_t i = 0; i < result.unplaced_words.size(); ++i)
-        cout << "\"" << result.unplaced_words[i] << "\"" << (i + 1 < result.unplaced_words.size() ? "," : "");
-    cout << "]\n}\n";
+    // Puzzle and solution images, then the result itself
+    if(render.enabled) {
+        string error;
+        if(!renderPuzzlePng(result, words, render, error)) {
+            cerr << "Cannot render: " << error << "\n";
+            return 1;
+        }
+    }
+
+    // Output as JSON, or as one binary record
+    JsonWriter writer;
+    if(style.binary) appendBinaryResult(writer.buffer, result, words);
+    else writeResultJson(writer, result, words, style.layout, "", style.stats);
+    if(style.progress) writer.raw('\n');
+    writer.flushTo(stdout);
 
     return 0;
 }
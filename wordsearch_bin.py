@@ -0,0 +1,81 @@
+"""
+Word Search Binary Reader
+-------------------------
+Decodes the records written by `wordsearch_solver --format=bin` (layout in
+binary_format.h) into the same dicts the JSON output parses to.
+"""
+
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHHHIIIII")
+PLACEMENT = struct.Struct("<HHHBx")
+DIRECTIONS = [(0, 1), (0, -1), (1, 0), (-1, 0), (1, 1), (1, -1), (-1, 1), (-1, -1)]
+FLAG_ERROR = 1
+
+
+def _string(buf, offset):
+    (length,) = struct.unpack_from("<H", buf, offset)
+    start = offset + 2
+    return bytes(buf[start:start + length]).decode("utf-8", "replace"), start + length
+
+
+def read_record(buf, offset=0):
+    """Decode the record at offset; returns (result dict, offset of the next record)."""
+    magic, version, flags, rows, cols, num_placements, num_words, overlap, size, _ = \
+        HEADER.unpack_from(buf, offset)
+    if magic != b"WSRB":
+        raise ValueError("not a word search record at offset %d" % offset)
+    if version != 1:
+        raise ValueError("unsupported record version %d" % version)
+
+    pos = offset + HEADER.size
+    grid = [bytes(buf[pos + r * cols:pos + (r + 1) * cols]).decode("ascii") for r in range(rows)]
+    pos += (rows * cols + 7) // 8 * 8
+
+    packed = [PLACEMENT.unpack_from(buf, pos + i * PLACEMENT.size) for i in range(num_placements)]
+    pos += num_placements * PLACEMENT.size
+
+    words = []
+    for _ in range(num_words):
+        word, pos = _string(buf, pos)
+        words.append(word)
+    record_id, pos = _string(buf, pos)
+
+    result = {}
+    if record_id:
+        result["id"] = record_id
+    if flags & FLAG_ERROR:
+        result["error"] = words[0]
+        return result, offset + size
+
+    placed_ids = {word_id for word_id, _, _, _ in packed}
+    result.update({
+        "rows": rows,
+        "cols": cols,
+        "grid": grid,
+        "placements": [
+            {"word": words[word_id], "row": row, "col": col,
+             "dr": DIRECTIONS[dir_index][0], "dc": DIRECTIONS[dir_index][1]}
+            for word_id, row, col, dir_index in packed
+        ],
+        "placed_words": [w for i, w in enumerate(words) if i in placed_ids],
+        "unplaced_words": [w for i, w in enumerate(words) if i not in placed_ids],
+        "total_overlap_score": overlap,
+    })
+    return result, offset + size
+
+
+def read_records(buf):
+    """Yield every record in a buffer of concatenated records (batch/server output)."""
+    offset = 0
+    while offset < len(buf):
+        result, offset = read_record(buf, offset)
+        yield result
+
+
+if __name__ == "__main__":
+    import json
+    data = open(sys.argv[1], "rb").read() if len(sys.argv) > 1 else sys.stdin.buffer.read()
+    for record in read_records(data):
+        print(json.dumps(record))